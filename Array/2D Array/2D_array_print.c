@@ -1,25 +1,893 @@
+// Matrix of ints : read, print, transpose, copy, load and save.
+
+// Storage is one contiguous row-major block. Every row starts on a cache line :
+// the row length (stride) is rounded up to 16 ints and the block is 64-byte
+// aligned, so rows never share a line and SIMD loads of a row are aligned.
+//  - Transpose : cache-oblivious. The bigger side is halved until a block is
+//    at most TRANSPOSE_BLOCK x TRANSPOSE_BLOCK, small enough for both the
+//    source rows and the destination rows to stay in L1 whatever the cache
+//    sizes are. Blocks are transposed 8 x 8 in AVX2 registers when the CPU
+//    has them.
+//  - Copy : rows are contiguous, so a row memcpy already streams both sides.
+//  - Text loader : the file is mapped and parsed in place, no scanf. A first
+//    pass counts the rows (non-blank lines), the first row gives the column
+//    count, then the values are parsed straight into their rows, up to 8
+//    digits at a time in one 64-bit word, with no branch on the sign. Big files
+//    are split at line breaks between threads ; each thread counts its rows
+//    first, so it knows the row its part starts at.
+//  - Binary format : a 24-byte header (magic, rows, cols) then the rows, cols
+//    native ints each. Loading is a mapping and one memcpy per row.
+
+// Input : a 2 x 3 matrix, one value at a time
+// Output : The 2D Matrix is :
+//          1 2 3
+//          4 5 6
+
+// Time Complexity : O(rows * cols) for every operation
+// Space Complexity : rows * stride ints
+
+// Compile : gcc -O2 -pthread 2D_array_print.c -o matrix
+// Run     : ./matrix                 (type a 2 x 3 matrix)
+//           ./matrix load <file>     (text or binary matrix file)
+//           ./matrix bench [logn]    (transpose and loaders)
+
 #include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<stdint.h>
+#include<time.h>
+#include<pthread.h>
+#include<fcntl.h>
+#include<unistd.h>
+#include<sys/mman.h>
+#include<sys/stat.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HAVE_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+#define CACHE_LINE 64
+#define LINE_INTS (CACHE_LINE / sizeof(int))
+
+// Largest block transposed without splitting
+#define TRANSPOSE_BLOCK 32
+
+#define MAX_THREADS 64
+
+// Smallest part of a text file worth a thread
+#define MIN_CHUNK (1 << 20)
+
+#define MATRIX_MAGIC "DSAMATX1"
+
+struct matrix
+{
+    size_t rows, cols;
+    size_t stride;  // ints from one row to the next, a multiple of LINE_INTS
+    int *data;      // CACHE_LINE aligned
+};
+
+#define MATRIX_AT(m, r, c) ((m)->data[(size_t)(r) * (m)->stride + (c)])
+
+struct matrix_header
+{
+    char magic[8];  // MATRIX_MAGIC
+    uint64_t rows;
+    uint64_t cols;
+};
+
+// Zero-filled rows x cols matrix, NULL when memory runs out
+struct matrix *matrix_create(size_t rows, size_t cols)
+{
+    struct matrix *m = (struct matrix *)malloc(sizeof(struct matrix));
+    size_t bytes;
+
+    if (m == NULL)
+    {
+        return NULL;
+    }
+    m->rows = rows;
+    m->cols = cols;
+    m->stride = (cols + LINE_INTS - 1) / LINE_INTS * LINE_INTS;
+    if (m->stride == 0)
+    {
+        m->stride = LINE_INTS;
+    }
+    if (rows > ((size_t)-1 / sizeof(int)) / m->stride)
+    {
+        free(m);
+        return NULL;
+    }
+    bytes = (rows ? rows : 1) * m->stride * sizeof(int);
+    m->data = (int *)aligned_alloc(CACHE_LINE, bytes);
+    if (m->data == NULL)
+    {
+        free(m);
+        return NULL;
+    }
+    memset(m->data, 0, bytes);
+    return m;
+}
+
+void matrix_free(struct matrix *m)
+{
+    if (m != NULL)
+    {
+        free(m->data);
+        free(m);
+    }
+}
+
+// Copies src into dst of the same shape. Returns -1 when the shapes differ.
+int matrix_copy(struct matrix *dst, const struct matrix *src)
+{
+    size_t r;
+
+    if (dst->rows != src->rows || dst->cols != src->cols)
+    {
+        return -1;
+    }
+    for (r = 0; r < src->rows; r++)
+    {
+        memcpy(&MATRIX_AT(dst, r, 0), &MATRIX_AT(src, r, 0), src->cols * sizeof(int));
+    }
+    return 0;
+}
+
+void matrix_print(const struct matrix *m, FILE *out)
+{
+    size_t r, c;
+
+    for (r = 0; r < m->rows; r++)
+    {
+        for (c = 0; c < m->cols; c++)
+        {
+            fprintf(out, (c + 1 < m->cols) ? "%d " : "%d", MATRIX_AT(m, r, c));
+        }
+        fputc('\n', out);
+    }
+}
+
+// ------------------------------------------------------------------
+// Transpose
+// ------------------------------------------------------------------
+
+// dst[c][r] = src[r][c] for a rows x cols block
+typedef void (*block_kernel)(const int *, size_t, int *, size_t, size_t, size_t);
+
+static void transpose_block_scalar(const int *src, size_t src_stride, int *dst, size_t dst_stride,
+                                   size_t rows, size_t cols)
+{
+    size_t r, c;
+
+    for (r = 0; r < rows; r++)
+    {
+        for (c = 0; c < cols; c++)
+        {
+            dst[c * dst_stride + r] = src[r * src_stride + c];
+        }
+    }
+}
+
+#ifdef HAVE_X86_SIMD
+
+__attribute__((target("avx2")))
+static void transpose_8x8_avx2(const int *src, size_t src_stride, int *dst, size_t dst_stride)
+{
+    __m256i r0 = _mm256_loadu_si256((const __m256i *)(src + 0 * src_stride));
+    __m256i r1 = _mm256_loadu_si256((const __m256i *)(src + 1 * src_stride));
+    __m256i r2 = _mm256_loadu_si256((const __m256i *)(src + 2 * src_stride));
+    __m256i r3 = _mm256_loadu_si256((const __m256i *)(src + 3 * src_stride));
+    __m256i r4 = _mm256_loadu_si256((const __m256i *)(src + 4 * src_stride));
+    __m256i r5 = _mm256_loadu_si256((const __m256i *)(src + 5 * src_stride));
+    __m256i r6 = _mm256_loadu_si256((const __m256i *)(src + 6 * src_stride));
+    __m256i r7 = _mm256_loadu_si256((const __m256i *)(src + 7 * src_stride));
+    __m256i t0, t1, t2, t3, t4, t5, t6, t7;
+
+    // Pairs of 32-bit lanes, then of 64-bit lanes, then the 128-bit halves
+    t0 = _mm256_unpacklo_epi32(r0, r1);
+    t1 = _mm256_unpackhi_epi32(r0, r1);
+    t2 = _mm256_unpacklo_epi32(r2, r3);
+    t3 = _mm256_unpackhi_epi32(r2, r3);
+    t4 = _mm256_unpacklo_epi32(r4, r5);
+    t5 = _mm256_unpackhi_epi32(r4, r5);
+    t6 = _mm256_unpacklo_epi32(r6, r7);
+    t7 = _mm256_unpackhi_epi32(r6, r7);
+
+    r0 = _mm256_unpacklo_epi64(t0, t2);
+    r1 = _mm256_unpackhi_epi64(t0, t2);
+    r2 = _mm256_unpacklo_epi64(t1, t3);
+    r3 = _mm256_unpackhi_epi64(t1, t3);
+    r4 = _mm256_unpacklo_epi64(t4, t6);
+    r5 = _mm256_unpackhi_epi64(t4, t6);
+    r6 = _mm256_unpacklo_epi64(t5, t7);
+    r7 = _mm256_unpackhi_epi64(t5, t7);
+
+    _mm256_storeu_si256((__m256i *)(dst + 0 * dst_stride), _mm256_permute2x128_si256(r0, r4, 0x20));
+    _mm256_storeu_si256((__m256i *)(dst + 1 * dst_stride), _mm256_permute2x128_si256(r1, r5, 0x20));
+    _mm256_storeu_si256((__m256i *)(dst + 2 * dst_stride), _mm256_permute2x128_si256(r2, r6, 0x20));
+    _mm256_storeu_si256((__m256i *)(dst + 3 * dst_stride), _mm256_permute2x128_si256(r3, r7, 0x20));
+    _mm256_storeu_si256((__m256i *)(dst + 4 * dst_stride), _mm256_permute2x128_si256(r0, r4, 0x31));
+    _mm256_storeu_si256((__m256i *)(dst + 5 * dst_stride), _mm256_permute2x128_si256(r1, r5, 0x31));
+    _mm256_storeu_si256((__m256i *)(dst + 6 * dst_stride), _mm256_permute2x128_si256(r2, r6, 0x31));
+    _mm256_storeu_si256((__m256i *)(dst + 7 * dst_stride), _mm256_permute2x128_si256(r3, r7, 0x31));
+}
+
+__attribute__((target("avx2")))
+static void transpose_block_avx2(const int *src, size_t src_stride, int *dst, size_t dst_stride,
+                                 size_t rows, size_t cols)
+{
+    size_t r, c, full_rows = rows & ~(size_t)7, full_cols = cols & ~(size_t)7;
+
+    for (r = 0; r < full_rows; r += 8)
+    {
+        for (c = 0; c < full_cols; c += 8)
+        {
+            transpose_8x8_avx2(src + r * src_stride + c, src_stride, dst + c * dst_stride + r, dst_stride);
+        }
+    }
+
+    // Right and bottom edges
+    transpose_block_scalar(src + full_cols, src_stride, dst + full_cols * dst_stride, dst_stride,
+                           full_rows, cols - full_cols);
+    transpose_block_scalar(src + full_rows * src_stride, src_stride, dst + full_rows, dst_stride,
+                           rows - full_rows, cols);
+}
+
+#endif
+
+static block_kernel get_block_kernel(void)
+{
+    static block_kernel kernel = NULL;
+
+    if (kernel == NULL)
+    {
+        kernel = transpose_block_scalar;
+#ifdef HAVE_X86_SIMD
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2"))
+        {
+            kernel = transpose_block_avx2;
+        }
+#endif
+    }
+    return kernel;
+}
+
+static void transpose_recursive(const int *src, size_t src_stride, int *dst, size_t dst_stride,
+                                size_t rows, size_t cols, block_kernel kernel)
+{
+    while (rows > TRANSPOSE_BLOCK || cols > TRANSPOSE_BLOCK)
+    {
+        // Halve the bigger side (on a multiple of 8 for the SIMD kernel)
+        if (rows >= cols)
+        {
+            size_t half = rows / 2 / 8 * 8;
+
+            transpose_recursive(src, src_stride, dst, dst_stride, half, cols, kernel);
+            src += half * src_stride;
+            dst += half;
+            rows -= half;
+        }
+        else
+        {
+            size_t half = cols / 2 / 8 * 8;
+
+            transpose_recursive(src, src_stride, dst, dst_stride, rows, half, kernel);
+            src += half;
+            dst += half * dst_stride;
+            cols -= half;
+        }
+    }
+    kernel(src, src_stride, dst, dst_stride, rows, cols);
+}
+
+// Writes the transpose of src to dst (cols x rows). Returns -1 when the shapes
+// do not match.
+int matrix_transpose_into(struct matrix *dst, const struct matrix *src)
+{
+    if (dst->rows != src->cols || dst->cols != src->rows)
+    {
+        return -1;
+    }
+    transpose_recursive(src->data, src->stride, dst->data, dst->stride, src->rows, src->cols, get_block_kernel());
+    return 0;
+}
+
+// New cols x rows matrix, NULL when memory runs out
+struct matrix *matrix_transpose(const struct matrix *src)
+{
+    struct matrix *dst = matrix_create(src->cols, src->rows);
+
+    if (dst != NULL)
+    {
+        matrix_transpose_into(dst, src);
+    }
+    return dst;
+}
+
+// ------------------------------------------------------------------
+// Text loader
+// ------------------------------------------------------------------
+
+static int is_blank(char ch)
+{
+    return ch == ' ' || ch == '\t' || ch == '\r' || ch == '\f' || ch == '\v';
+}
+
+// End of the line starting at p (the '\n' or end)
+static const char *line_end(const char *p, const char *end)
+{
+    const char *nl = (const char *)memchr(p, '\n', (size_t)(end - p));
+
+    return (nl != NULL) ? nl : end;
+}
+
+static int line_is_empty(const char *p, const char *eol)
+{
+    while (p < eol && is_blank(*p))
+    {
+        p++;
+    }
+    return p == eol;
+}
+
+// Leading digits of p[0 .. 8), up to all 8 of them, converted together (SWAR) :
+// a byte is a digit when its high nibble is 3 and adding 6 keeps it so. The
+// digits are shifted to the top of the word, then pairs, quads and octets of
+// digits are merged with one multiply each. Returns how many digits there were.
+static int parse_8_digits(const char *p, unsigned long long *value)
+{
+    unsigned long long chunk, low, other;
+    int len;
+
+    memcpy(&chunk, p, 8);
+    low = chunk & 0x7F7F7F7F7F7F7F7FULL;
+    other = ((low & 0xF0F0F0F0F0F0F0F0ULL) ^ 0x3030303030303030ULL)
+          | (((low + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) ^ 0x3030303030303030ULL)
+          | (chunk & 0x8080808080808080ULL);
+    len = (other != 0) ? __builtin_ctzll(other) / 8 : 8;
+    if (len == 0)
+    {
+        return 0;
+    }
+
+    chunk = (chunk & 0x0F0F0F0F0F0F0F0FULL) << (8 * (8 - len));
+    chunk = (chunk * 2561) >> 8;
+    chunk = ((chunk & 0x00FF00FF00FF00FFULL) * 6553601) >> 16;
+    chunk = ((chunk & 0x0000FFFF0000FFFFULL) * 42949672960001ULL) >> 32;
+    *value = chunk;
+    return len;
+}
+
+// Parses the values of one line into row[] (only counts them when row is
+// NULL). Returns how many there were, or -1 on a malformed value, a value out
+// of the int range or more than max.
+static long parse_line(const char *p, const char *eol, int row[], size_t max)
+{
+    size_t count = 0;
+
+    for (;;)
+    {
+        unsigned long long value = 0;
+        const char *digits;
+        int negative;
+
+        while (p < eol && is_blank(*p))
+        {
+            p++;
+        }
+        if (p == eol)
+        {
+            return (long)count;
+        }
+        // Branchless : the signs are random in real data
+        negative = (*p == '-');
+        p += negative | (*p == '+');
+
+        digits = p;
+        if (eol - p >= 8)
+        {
+            p += parse_8_digits(p, &value);
+        }
+        while (p < eol && (unsigned)(*p - '0') < 10 && value <= 2147483648ULL)
+        {
+            value = value * 10 + (unsigned)(*p - '0');
+            p++;
+        }
+        if (p == digits || value > 2147483647ULL + (unsigned)negative || (p < eol && !is_blank(*p))
+            || count == max)
+        {
+            return -1;
+        }
+        if (row != NULL)
+        {
+            row[count] = negative ? (int)(0 - value) : (int)value;
+        }
+        count++;
+    }
+}
+
+struct parse_job
+{
+    const char *begin, *end;    // whole lines
+    struct matrix *m;           // NULL on the counting pass
+    size_t first_row;
+    size_t rows;                // counted rows
+    int failed;
+};
+
+static void *parse_worker(void *arg)
+{
+    struct parse_job *job = (struct parse_job *)arg;
+    const char *p = job->begin;
+    size_t r = job->first_row;
+
+    while (p < job->end)
+    {
+        const char *eol = line_end(p, job->end);
+
+        if (!line_is_empty(p, eol))
+        {
+            if (job->m == NULL)
+            {
+                job->rows++;
+            }
+            else if (parse_line(p, eol, &MATRIX_AT(job->m, r, 0), job->m->cols) != (long)job->m->cols)
+            {
+                job->failed = 1;
+                return NULL;
+            }
+            r++;
+        }
+        p = eol + 1;
+    }
+    return NULL;
+}
+
+// Runs parse_worker on every job, on up to `count` threads
+static void run_jobs(struct parse_job jobs[], int count)
+{
+    pthread_t tid[MAX_THREADS];
+    int started[MAX_THREADS];
+    int t;
+
+    for (t = 1; t < count; t++)
+    {
+        started[t] = (pthread_create(&tid[t], NULL, parse_worker, &jobs[t]) == 0);
+        if (!started[t])
+        {
+            parse_worker(&jobs[t]);
+        }
+    }
+    parse_worker(&jobs[0]);
+    for (t = 1; t < count; t++)
+    {
+        if (started[t])
+        {
+            pthread_join(tid[t], NULL);
+        }
+    }
+}
+
+// Matrix from whitespace-separated integers, one row per non-blank line, all
+// rows as long as the first. Returns NULL on malformed text or no memory.
+struct matrix *matrix_parse_text(const char *text, size_t length, int threads)
+{
+    struct parse_job jobs[MAX_THREADS];
+    const char *end = text + length, *p = text;
+    struct matrix *m;
+    size_t rows = 0, chunk;
+    long cols = -1;
+    int t, parts;
+
+    // Columns : values of the first non-blank line
+    while (p < end && cols < 0)
+    {
+        const char *eol = line_end(p, end);
+
+        if (!line_is_empty(p, eol))
+        {
+            cols = parse_line(p, eol, NULL, (size_t)-1);
+            break;
+        }
+        p = eol + 1;
+    }
+    if (cols <= 0)
+    {
+        return NULL;
+    }
+
+    // Parts end on line breaks
+    if (threads > MAX_THREADS)
+    {
+        threads = MAX_THREADS;
+    }
+    parts = threads;
+    if ((size_t)parts > length / MIN_CHUNK)
+    {
+        parts = (int)(length / MIN_CHUNK);
+    }
+    if (parts < 1)
+    {
+        parts = 1;
+    }
+    chunk = length / parts;
+    p = text;
+    for (t = 0; t < parts; t++)
+    {
+        const char *stop = (t + 1 < parts) ? text + (t + 1) * chunk : end;
+
+        if (stop < p)
+        {
+            stop = p;
+        }
+        if (stop < end)
+        {
+            stop = line_end(stop, end);
+            stop += (stop < end);
+        }
+        jobs[t].begin = p;
+        jobs[t].end = stop;
+        jobs[t].m = NULL;
+        jobs[t].first_row = 0;
+        jobs[t].rows = 0;
+        jobs[t].failed = 0;
+        p = stop;
+    }
 
-int main(){
-    int arr[2][3];
+    run_jobs(jobs, parts);
+    for (t = 0; t < parts; t++)
+    {
+        jobs[t].first_row = rows;
+        rows += jobs[t].rows;
+    }
+
+    m = matrix_create(rows, (size_t)cols);
+    if (m == NULL)
+    {
+        return NULL;
+    }
+    for (t = 0; t < parts; t++)
+    {
+        jobs[t].m = m;
+    }
+    run_jobs(jobs, parts);
+    for (t = 0; t < parts; t++)
+    {
+        if (jobs[t].failed)
+        {
+            matrix_free(m);
+            return NULL;
+        }
+    }
+    return m;
+}
+
+// Maps path read-only ; returns the mapping or NULL, its size in *bytes
+static const char *map_file(const char *path, size_t *bytes)
+{
+    struct stat st;
+    void *map;
+    int fd = open(path, O_RDONLY);
+
+    if (fd < 0)
+    {
+        return NULL;
+    }
+    if (fstat(fd, &st) != 0 || st.st_size == 0)
+    {
+        close(fd);
+        return NULL;
+    }
+    map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+    {
+        return NULL;
+    }
+    madvise(map, (size_t)st.st_size, MADV_SEQUENTIAL);
+    *bytes = (size_t)st.st_size;
+    return (const char *)map;
+}
+
+// Text matrix file, see matrix_parse_text(). NULL when it cannot be read.
+struct matrix *matrix_load_text(const char *path, int threads)
+{
+    size_t bytes;
+    const char *text = map_file(path, &bytes);
+    struct matrix *m;
+
+    if (text == NULL)
+    {
+        return NULL;
+    }
+    m = matrix_parse_text(text, bytes, threads);
+    munmap((void *)text, bytes);
+    return m;
+}
+
+// ------------------------------------------------------------------
+// Binary format
+// ------------------------------------------------------------------
+
+// Returns 0 on success, -1 on error
+int matrix_save(const struct matrix *m, const char *path)
+{
+    struct matrix_header h;
+    FILE *out = fopen(path, "wb");
+    size_t r;
+    int rc = 0;
+
+    if (out == NULL)
+    {
+        return -1;
+    }
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, MATRIX_MAGIC, 8);
+    h.rows = m->rows;
+    h.cols = m->cols;
+    if (fwrite(&h, sizeof(h), 1, out) != 1)
+    {
+        rc = -1;
+    }
+    for (r = 0; r < m->rows && rc == 0 && m->cols > 0; r++)
+    {
+        if (fwrite(&MATRIX_AT(m, r, 0), sizeof(int), m->cols, out) != m->cols)
+        {
+            rc = -1;
+        }
+    }
+    if (fclose(out) != 0)
+    {
+        rc = -1;
+    }
+    return rc;
+}
+
+// Binary matrix file ; NULL when it cannot be read or is not one
+struct matrix *matrix_load(const char *path)
+{
+    struct matrix_header h;
+    struct matrix *m = NULL;
+    size_t bytes, r;
+    const char *map = map_file(path, &bytes);
+
+    if (map == NULL)
+    {
+        return NULL;
+    }
+    memcpy(&h, map, bytes < sizeof(h) ? bytes : sizeof(h));
+    if (bytes >= sizeof(h) && memcmp(h.magic, MATRIX_MAGIC, 8) == 0
+        && (h.cols == 0 || h.rows <= (bytes - sizeof(h)) / sizeof(int) / h.cols)
+        && sizeof(h) + h.rows * h.cols * sizeof(int) == bytes)
+    {
+        m = matrix_create((size_t)h.rows, (size_t)h.cols);
+    }
+    if (m != NULL)
+    {
+        const char *src = map + sizeof(h);
+
+        for (r = 0; r < m->rows; r++)
+        {
+            memcpy(&MATRIX_AT(m, r, 0), src + r * m->cols * sizeof(int), m->cols * sizeof(int));
+        }
+    }
+    munmap((void *)map, bytes);
+    return m;
+}
+
+// Binary file if it starts with the magic, text otherwise
+struct matrix *matrix_load_any(const char *path, int threads)
+{
+    char magic[8] = {0};
+    FILE *in = fopen(path, "rb");
+    size_t got;
+
+    if (in == NULL)
+    {
+        return NULL;
+    }
+    got = fread(magic, 1, 8, in);
+    fclose(in);
+    if (got == 8 && memcmp(magic, MATRIX_MAGIC, 8) == 0)
+    {
+        return matrix_load(path);
+    }
+    return matrix_load_text(path, threads);
+}
+
+// ------------------------------------------------------------------
+// Benchmark
+// ------------------------------------------------------------------
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static unsigned long long rng_state = 88172645463325252ULL;
+
+static unsigned long long next_random(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return rng_state;
+}
+
+static void run_benchmark(int log_n)
+{
+    size_t side = (size_t)1 << (log_n / 2), r, c, cells = side * side;
+    int threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    char text_path[] = "/tmp/dsa_matrix_XXXXXX", bin_path[] = "/tmp/dsa_matrix_XXXXXX";
+    struct matrix *m = matrix_create(side, side), *t = matrix_create(side, side), *loaded;
+    double t0, t_naive, t_tiled, t_text, t_scanf, t_save, t_load;
+    size_t text_bytes = 0, scanned = 0;
+    struct stat st;
+    FILE *fp;
+    int value, text_fd, bin_fd;
+
+    if (m == NULL || t == NULL)
+    {
+        printf("Out of memory.\n");
+        matrix_free(m);
+        matrix_free(t);
+        return;
+    }
+
+    // Private temporary files, never a fixed name someone else may own
+    text_fd = mkstemp(text_path);
+    bin_fd = mkstemp(bin_path);
+    if (bin_fd >= 0)
+    {
+        close(bin_fd);
+    }
+    fp = (text_fd >= 0) ? fdopen(text_fd, "w") : NULL;
+    if (fp == NULL || bin_fd < 0)
+    {
+        printf("Cannot create a temporary file.\n");
+        if (fp != NULL)
+        {
+            fclose(fp);
+        }
+        else if (text_fd >= 0)
+        {
+            close(text_fd);
+        }
+        if (text_fd >= 0)
+        {
+            unlink(text_path);
+        }
+        if (bin_fd >= 0)
+        {
+            unlink(bin_path);
+        }
+        matrix_free(m);
+        matrix_free(t);
+        return;
+    }
+    for (r = 0; r < side; r++)
+    {
+        for (c = 0; c < side; c++)
+        {
+            MATRIX_AT(m, r, c) = (int)(next_random() % 2000001) - 1000000;
+        }
+    }
+    memset(t->data, 0, side * t->stride * sizeof(int));
+
+    t0 = now_seconds();
+    for (r = 0; r < side; r++)
+    {
+        for (c = 0; c < side; c++)
+        {
+            MATRIX_AT(t, c, r) = MATRIX_AT(m, r, c);
+        }
+    }
+    t_naive = now_seconds() - t0;
+
+    t0 = now_seconds();
+    matrix_transpose_into(t, m);
+    t_tiled = now_seconds() - t0;
+
+    matrix_print(m, fp);
+    fclose(fp);
+    if (stat(text_path, &st) == 0)
+    {
+        text_bytes = (size_t)st.st_size;
+    }
+
+    t0 = now_seconds();
+    loaded = matrix_load_text(text_path, threads);
+    t_text = now_seconds() - t0;
+    if (loaded == NULL || loaded->rows != side || loaded->cols != side)
+    {
+        printf("Text load failed.\n");
+    }
+    matrix_free(loaded);
+
+    fp = fopen(text_path, "r");
+    t0 = now_seconds();
+    while (fp != NULL && fscanf(fp, "%d", &value) == 1)
+    {
+        scanned++;
+    }
+    t_scanf = now_seconds() - t0;
+    if (fp != NULL)
+    {
+        fclose(fp);
+    }
+
+    t0 = now_seconds();
+    matrix_save(m, bin_path);
+    t_save = now_seconds() - t0;
+    t0 = now_seconds();
+    loaded = matrix_load(bin_path);
+    t_load = now_seconds() - t0;
+    matrix_free(loaded);
+
+    printf("%zu x %zu ints, %d thread(s)\n", side, side, threads);
+    printf("  naive transpose  : %8.2f ns / cell\n", t_naive / cells * 1e9);
+    printf("  tiled transpose  : %8.2f ns / cell\n", t_tiled / cells * 1e9);
+    printf("  text loader      : %8.2f GB/s\n", text_bytes / t_text * 1e-9);
+    printf("  fscanf           : %8.2f GB/s (%zu values)\n", text_bytes / t_scanf * 1e-9, scanned);
+    printf("  binary save      : %8.2f GB/s\n", cells * sizeof(int) / t_save * 1e-9);
+    printf("  binary load      : %8.2f GB/s\n", cells * sizeof(int) / t_load * 1e-9);
+
+    unlink(text_path);
+    unlink(bin_path);
+    matrix_free(m);
+    matrix_free(t);
+}
+
+int main(int argc, char *argv[]){
+    struct matrix *m;
     int i, j, row = 2, column = 3;
 
-    for(i = 0; i < row; i++){
-        for(j = 0; j < column; j++){
-            printf("Enter value of arr[%d][%d] = ",i,j);
-            scanf("%d" , &arr[i][j]);
+    if (argc > 1 && strcmp(argv[1], "bench") == 0)
+    {
+        run_benchmark(argc > 2 ? atoi(argv[2]) : 24);
+        return 0;
+    }
+    if (argc > 2 && strcmp(argv[1], "load") == 0)
+    {
+        m = matrix_load_any(argv[2], (int)sysconf(_SC_NPROCESSORS_ONLN));
+        if (m == NULL)
+        {
+            printf("Cannot read %s.\n", argv[2]);
+            return 1;
         }
+        printf("%zu x %zu matrix\n", m->rows, m->cols);
+        matrix_free(m);
+        return 0;
     }
 
-    printf("\n\n");
+    m = matrix_create(row, column);
+    if (m == NULL)
+    {
+        printf("Out of memory.\n");
+        return 1;
+    }
 
-    printf("The 2D Matrix is : ");
     for(i = 0; i < row; i++){
         for(j = 0; j < column; j++){
-            printf("%d",arr[i][j]);
+            printf("Enter value of arr[%d][%d] = ",i,j);
+            if (scanf("%d" , &MATRIX_AT(m, i, j)) != 1)
+            {
+                matrix_free(m);
+                return 1;
+            }
         }
-        printf("\n");
     }
 
+    printf("\n\n");
+
+    printf("The 2D Matrix is :\n");
+    matrix_print(m, stdout);
+
+    matrix_free(m);
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,518 @@
+// Maximum sum rectangle of a 2D grid (2D Kadane), and the best k x l window.
+
+// Input : grid[4][5] = {{ 1,  2, -1, -4, -20},
+//                       {-8, -3,  4,  2,   1},
+//                       { 3,  8, 10,  1,   3},
+//                       {-4, -1,  1,  7,  -6}}
+// Output : The maximum sum = 29, rows 1 to 3, columns 1 to 3
+
+// Any rectangle is a band of rows [top, bottom) and a range of columns. For a
+// fixed top, the bands are grown one row at a time : the row is added to the
+// column sums of the band, and 1D Kadane on those sums gives the best column
+// range of the band. O(rows^2 * cols).
+//  - The row is added 4 (AVX2) or 8 (AVX-512) columns at a time, widened to
+//    64-bit so sums of any grid fit. A row is contiguous, which is why the
+//    pairs are pairs of rows : a grid with more rows than columns is
+//    transposed first, so the squared side is always the shorter one.
+//  - The tops are shared between threads through an atomic counter (early
+//    tops have more bands), each thread with its own column sums. The best
+//    rectangles are merged with ties going to the first top, so the result
+//    does not depend on the thread count.
+//  - Fixed k x l window : 2D prefix sums P[r][c] = sum of grid[0 .. r)[0 .. c)
+//    give any rectangle sum in O(1), P[b][r] - P[t][r] - P[b][l] + P[t][l].
+// Rectangles are [top, bottom) x [left, right).
+
+// Time Complexity : O(min(rows, cols)^2 * max(rows, cols) / threads),
+//                   O(rows * cols) for a fixed window
+// Space Complexity : O(cols * threads), O(rows * cols) for the prefix sums
+
+// Compile : gcc -O2 -pthread Maximum_Sum_Submatrix.c -o max_submatrix
+// Run     : ./max_submatrix              (small example)
+//           ./max_submatrix bench [logn] (2^logn cells, serial against threaded)
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<limits.h>
+#include<time.h>
+#include<pthread.h>
+#include<unistd.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HAVE_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+#define MAX_THREADS 64
+
+#define CELL(grid, stride, r, c) ((grid)[(size_t)(r) * (stride) + (c)])
+
+struct rectangle
+{
+    long long sum;
+    size_t top, left, bottom, right;
+};
+
+// ------------------------------------------------------------------
+// Row accumulation
+// ------------------------------------------------------------------
+
+// sums[c] += row[c]
+typedef void (*add_kernel)(long long *, const int *, size_t);
+
+static void add_row_scalar(long long sums[], const int row[], size_t n)
+{
+    size_t c;
+
+    for (c = 0; c < n; c++)
+    {
+        sums[c] += row[c];
+    }
+}
+
+#ifdef HAVE_X86_SIMD
+
+__attribute__((target("avx2")))
+static void add_row_avx2(long long sums[], const int row[], size_t n)
+{
+    size_t c = 0;
+
+    for (; c + 4 <= n; c += 4)
+    {
+        __m256i wide = _mm256_cvtepi32_epi64(_mm_loadu_si128((const __m128i *)(row + c)));
+        __m256i s = _mm256_loadu_si256((const __m256i *)(sums + c));
+
+        _mm256_storeu_si256((__m256i *)(sums + c), _mm256_add_epi64(s, wide));
+    }
+    add_row_scalar(sums + c, row + c, n - c);
+}
+
+__attribute__((target("avx512f")))
+static void add_row_avx512(long long sums[], const int row[], size_t n)
+{
+    size_t c = 0;
+
+    for (; c + 8 <= n; c += 8)
+    {
+        __m512i wide = _mm512_cvtepi32_epi64(_mm256_loadu_si256((const __m256i *)(row + c)));
+        __m512i s = _mm512_loadu_si512((const void *)(sums + c));
+
+        _mm512_storeu_si512((void *)(sums + c), _mm512_add_epi64(s, wide));
+    }
+    add_row_scalar(sums + c, row + c, n - c);
+}
+
+#endif
+
+static add_kernel get_add_kernel(void)
+{
+    static add_kernel kernel = NULL;
+
+    if (kernel == NULL)
+    {
+        kernel = add_row_scalar;
+#ifdef HAVE_X86_SIMD
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f"))
+        {
+            kernel = add_row_avx512;
+        }
+        else if (__builtin_cpu_supports("avx2"))
+        {
+            kernel = add_row_avx2;
+        }
+#endif
+    }
+    return kernel;
+}
+
+// ------------------------------------------------------------------
+// Maximum sum rectangle
+// ------------------------------------------------------------------
+
+// Kadane over sums[0 .. n) ; updates *best when a range beats it
+static void kadane_band(const long long sums[], size_t n, size_t top, size_t bottom, struct rectangle *best)
+{
+    long long current = 0, best_sum = best->sum;
+    size_t start = 0, c;
+
+    // Restart on a non-positive run, written so it compiles to conditional
+    // moves. best_sum is local : best->sum could alias sums[].
+    for (c = 0; c < n; c++)
+    {
+        int restart = (current <= 0);
+
+        start = restart ? c : start;
+        current = (restart ? 0 : current) + sums[c];
+        if (current > best_sum)
+        {
+            best_sum = current;
+            best->top = top;
+            best->bottom = bottom;
+            best->left = start;
+            best->right = c + 1;
+        }
+    }
+    best->sum = best_sum;
+}
+
+struct band_job
+{
+    const int *grid;
+    size_t rows, cols, stride;
+    size_t *next_top;   // shared counter
+    long long *sums;
+    add_kernel add;
+    struct rectangle best;
+};
+
+static void *band_worker(void *arg)
+{
+    struct band_job *job = (struct band_job *)arg;
+    size_t top, bottom;
+
+    job->best.sum = LLONG_MIN;
+    job->best.top = job->best.left = job->best.bottom = job->best.right = 0;
+
+    while ((top = __atomic_fetch_add(job->next_top, 1, __ATOMIC_RELAXED)) < job->rows)
+    {
+        memset(job->sums, 0, job->cols * sizeof(long long));
+        for (bottom = top; bottom < job->rows; bottom++)
+        {
+            job->add(job->sums, &CELL(job->grid, job->stride, bottom, 0), job->cols);
+            kadane_band(job->sums, job->cols, top, bottom + 1, &job->best);
+        }
+    }
+    return NULL;
+}
+
+// a is better than b : bigger sum, then the first top, bottom, left
+static int better(const struct rectangle *a, const struct rectangle *b)
+{
+    if (a->sum != b->sum)
+    {
+        return a->sum > b->sum;
+    }
+    if (a->top != b->top)
+    {
+        return a->top < b->top;
+    }
+    if (a->bottom != b->bottom)
+    {
+        return a->bottom < b->bottom;
+    }
+    return a->left < b->left;
+}
+
+// Copy of the grid with rows and columns swapped, NULL when memory runs out
+static int *transposed_copy(const int *grid, size_t rows, size_t cols, size_t stride)
+{
+    int *copy = (int *)malloc(rows * cols * sizeof(int));
+    size_t r0, c0, r, c;
+
+    if (copy == NULL)
+    {
+        return NULL;
+    }
+    // 32 x 32 tiles, so both sides stay in cache
+    for (r0 = 0; r0 < rows; r0 += 32)
+    {
+        for (c0 = 0; c0 < cols; c0 += 32)
+        {
+            for (r = r0; r < rows && r < r0 + 32; r++)
+            {
+                for (c = c0; c < cols && c < c0 + 32; c++)
+                {
+                    copy[c * rows + r] = CELL(grid, stride, r, c);
+                }
+            }
+        }
+    }
+    return copy;
+}
+
+// Best non-empty rectangle of a rows x cols grid (row-major, `stride` ints
+// between rows), on up to `threads` threads. Returns 0, or -1 for an empty
+// grid or when memory runs out.
+int max_submatrix(const int *grid, size_t rows, size_t cols, size_t stride, int threads, struct rectangle *best)
+{
+    struct band_job jobs[MAX_THREADS];
+    pthread_t tid[MAX_THREADS];
+    int started[MAX_THREADS];
+    int *copy = NULL, t, rc = 0;
+    size_t next_top = 0;
+
+    if (rows == 0 || cols == 0)
+    {
+        return -1;
+    }
+    if (rows > cols)
+    {
+        copy = transposed_copy(grid, rows, cols, stride);
+        if (copy == NULL)
+        {
+            return -1;
+        }
+        grid = copy;
+        stride = rows;
+        rows = cols;
+        cols = stride;
+    }
+
+    if (threads > MAX_THREADS)
+    {
+        threads = MAX_THREADS;
+    }
+    if ((size_t)threads > rows)
+    {
+        threads = (int)rows;
+    }
+    if (threads < 1)
+    {
+        threads = 1;
+    }
+
+    for (t = 0; t < threads; t++)
+    {
+        jobs[t].grid = grid;
+        jobs[t].rows = rows;
+        jobs[t].cols = cols;
+        jobs[t].stride = stride;
+        jobs[t].next_top = &next_top;
+        jobs[t].add = get_add_kernel();
+        jobs[t].sums = (long long *)malloc(cols * sizeof(long long));
+        if (jobs[t].sums == NULL)
+        {
+            rc = -1;
+        }
+    }
+
+    if (rc == 0)
+    {
+        for (t = 1; t < threads; t++)
+        {
+            started[t] = (pthread_create(&tid[t], NULL, band_worker, &jobs[t]) == 0);
+            if (!started[t])
+            {
+                band_worker(&jobs[t]);
+            }
+        }
+        band_worker(&jobs[0]);
+        for (t = 1; t < threads; t++)
+        {
+            if (started[t])
+            {
+                pthread_join(tid[t], NULL);
+            }
+        }
+
+        *best = jobs[0].best;
+        for (t = 1; t < threads; t++)
+        {
+            if (better(&jobs[t].best, best))
+            {
+                *best = jobs[t].best;
+            }
+        }
+
+        // Back to the grid's own rows and columns
+        if (copy != NULL)
+        {
+            size_t top = best->top, bottom = best->bottom;
+
+            best->top = best->left;
+            best->bottom = best->right;
+            best->left = top;
+            best->right = bottom;
+        }
+    }
+
+    for (t = 0; t < threads; t++)
+    {
+        free(jobs[t].sums);
+    }
+    free(copy);
+    return rc;
+}
+
+// ------------------------------------------------------------------
+// Fixed k x l window
+// ------------------------------------------------------------------
+
+// (rows + 1) x (cols + 1) prefix sums, row 0 and column 0 are zero
+struct prefix_sums_2d
+{
+    size_t rows, cols;
+    long long *sums;
+};
+
+#define PREFIX(p, r, c) ((p)->sums[(size_t)(r) * ((p)->cols + 1) + (c)])
+
+// Returns 0, or -1 when memory runs out
+int prefix_sums_2d_build(struct prefix_sums_2d *p, const int *grid, size_t rows, size_t cols, size_t stride)
+{
+    size_t r, c;
+
+    p->rows = rows;
+    p->cols = cols;
+    p->sums = (long long *)malloc((rows + 1) * (cols + 1) * sizeof(long long));
+    if (p->sums == NULL)
+    {
+        return -1;
+    }
+
+    memset(p->sums, 0, (cols + 1) * sizeof(long long));
+    for (r = 0; r < rows; r++)
+    {
+        long long running = 0;
+
+        // Row r + 1 = row r + running sum of grid row r
+        PREFIX(p, r + 1, 0) = 0;
+        for (c = 0; c < cols; c++)
+        {
+            running += CELL(grid, stride, r, c);
+            PREFIX(p, r + 1, c + 1) = PREFIX(p, r, c + 1) + running;
+        }
+    }
+    return 0;
+}
+
+void prefix_sums_2d_free(struct prefix_sums_2d *p)
+{
+    free(p->sums);
+    p->sums = NULL;
+}
+
+// Sum of [top, bottom) x [left, right) in O(1)
+long long rectangle_sum(const struct prefix_sums_2d *p, size_t top, size_t left, size_t bottom, size_t right)
+{
+    return PREFIX(p, bottom, right) - PREFIX(p, top, right) - PREFIX(p, bottom, left) + PREFIX(p, top, left);
+}
+
+// Best k x l window (k rows, l columns). Returns 0, or -1 when the window
+// does not fit or memory runs out.
+int max_window_2d(const int *grid, size_t rows, size_t cols, size_t stride, size_t k, size_t l,
+                  struct rectangle *best)
+{
+    struct prefix_sums_2d p;
+    size_t r, c;
+
+    if (k == 0 || l == 0 || k > rows || l > cols || prefix_sums_2d_build(&p, grid, rows, cols, stride) != 0)
+    {
+        return -1;
+    }
+
+    best->sum = LLONG_MIN;
+    for (r = 0; r + k <= rows; r++)
+    {
+        const long long *upper = &PREFIX(&p, r, 0), *lower = &PREFIX(&p, r + k, 0);
+
+        // Row pair of the prefix table, read left to right
+        for (c = 0; c + l <= cols; c++)
+        {
+            long long sum = lower[c + l] - upper[c + l] - lower[c] + upper[c];
+
+            if (sum > best->sum)
+            {
+                best->sum = sum;
+                best->top = r;
+                best->left = c;
+            }
+        }
+    }
+    best->bottom = best->top + k;
+    best->right = best->left + l;
+
+    prefix_sums_2d_free(&p);
+    return 0;
+}
+
+// ------------------------------------------------------------------
+// Benchmark
+// ------------------------------------------------------------------
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static unsigned long long rng_state = 88172645463325252ULL;
+
+static unsigned long long next_random(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return rng_state;
+}
+
+static void run_benchmark(int log_n)
+{
+    size_t side = (size_t)1 << (log_n / 2), i;
+    int threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    int *grid = (int *)malloc(side * side * sizeof(int));
+    struct rectangle serial, threaded, window;
+    double t0, t_serial, t_threaded, t_window;
+
+    if (grid == NULL)
+    {
+        printf("Out of memory.\n");
+        return;
+    }
+
+    // Values in [-1000, 1000]
+    for (i = 0; i < side * side; i++)
+    {
+        grid[i] = (int)(next_random() % 2001) - 1000;
+    }
+
+    t0 = now_seconds();
+    max_submatrix(grid, side, side, side, 1, &serial);
+    t_serial = now_seconds() - t0;
+
+    t0 = now_seconds();
+    max_submatrix(grid, side, side, side, threads, &threaded);
+    t_threaded = now_seconds() - t0;
+
+    t0 = now_seconds();
+    max_window_2d(grid, side, side, side, 64, 64, &window);
+    t_window = now_seconds() - t0;
+
+    printf("%zu x %zu grid\n", side, side);
+    printf("  1 thread    : %8.3f s, sum %lld\n", t_serial, serial.sum);
+    printf("  %2d thread(s): %8.3f s, sum %lld, rows [%zu, %zu) columns [%zu, %zu)\n", threads, t_threaded,
+           threaded.sum, threaded.top, threaded.bottom, threaded.left, threaded.right);
+    printf("  64 x 64     : %8.3f s, sum %lld\n", t_window, window.sum);
+
+    free(grid);
+}
+
+int main(int argc, char *argv[])
+{
+    int grid[4][5] = {
+        { 1,  2, -1, -4, -20},
+        {-8, -3,  4,  2,   1},
+        { 3,  8, 10,  1,   3},
+        {-4, -1,  1,  7,  -6}
+    };
+    struct rectangle best;
+
+    if (argc > 1 && strcmp(argv[1], "bench") == 0)
+    {
+        run_benchmark(argc > 2 ? atoi(argv[2]) : 20);
+        return 0;
+    }
+
+    max_submatrix(&grid[0][0], 4, 5, 5, 1, &best);
+    printf("\nThe maximum sum = %lld, rows %zu to %zu, columns %zu to %zu",
+           best.sum, best.top, best.bottom - 1, best.left, best.right - 1);
+
+    max_window_2d(&grid[0][0], 4, 5, 5, 2, 2, &best);
+    printf("\nThe best 2 x 2 window = %lld, rows %zu to %zu, columns %zu to %zu\n",
+           best.sum, best.top, best.bottom - 1, best.left, best.right - 1);
+
+    return 0;
+}
@@ -1,46 +1,382 @@
 // Find common elements in three sorted array.
+// Generalized to k sorted arrays (2 to KWAY_MAX_LISTS).
 
-// Time Complexity : O(n1 + n2 + n3)
-// Space Complexity : O(1)
+// The arrays are sets : sorted, no repeated value inside one array.
+// 1. The arrays are ordered by length, the smallest one gives the candidates.
+// 2. A candidate is searched in the other arrays, shortest first, each one
+//    resuming from its previous position. The first array that does not have
+//    it returns the next bigger value, and the smallest array jumps straight
+//    to that value. So long runs that cannot match are skipped, not scanned.
+// 3. A search first compares the next 16 elements with SIMD (AVX2 / AVX-512,
+//    one compare and a popcount give the position), which settles it for
+//    dense arrays ; only when the value is further away it gallops (steps 1,
+//    2, 4 ... then binary search).
+// 4. kway_intersect_parallel() cuts the smallest array into one key range per
+//    thread, finds the same range in every other array by binary search, and
+//    runs the same loop on each slice.
+// Matches are reported through a callback or written into an output buffer.
+
+// Time Complexity : O(k * m * log(n / m)) for smallest size m, largest size n
+// Space Complexity : O(k)
+
+// Compile : gcc -O2 -pthread Common_Element_ThreeArray.c -o common_elements
 
 #include<stdio.h>
-int main()
+#include<stdlib.h>
+#include<string.h>
+#include<pthread.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HAVE_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+#define KWAY_MAX_LISTS 64
+#define KWAY_MAX_THREADS 64
+
+typedef void (*match_callback)(int value, void *ctx);
+
+// ------------------------------------------------------------------
+// advance() : first index >= from with arr[index] >= target
+// ------------------------------------------------------------------
+
+static size_t gallop(const int arr[], size_t n, size_t from, int target)
 {
-    int arr1[] = {1, 5, 10, 20, };
-    int arr2[] = {1, 2, 4, 6, 8, 10};
-    int arr3[] = {1, 2, 3, 4, 5};
+    size_t low = from, probe = from, step = 1, high;
 
-    int size_arr1 = sizeof(arr1) / sizeof(arr1[0]);
-    int size_arr2 = sizeof(arr2) / sizeof(arr2[0]);
-    int size_arr3 = sizeof(arr3) / sizeof(arr3[0]);
+    while (probe < n && arr[probe] < target)
+    {
+        low = probe + 1;
+        probe = low + step - 1;
+        step *= 2;
+    }
+    high = (probe < n) ? probe : n;
 
-    int i = 0, j = 0, k = 0;
+    while (low < high)
+    {
+        size_t mid = low + (high - low) / 2;
 
-    printf("\nCommon Elements are : ");
+        if (arr[mid] < target)
+        {
+            low = mid + 1;
+        }
+        else
+        {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+static size_t advance_scalar(const int arr[], size_t n, size_t from, int target)
+{
+    return gallop(arr, n, from, target);
+}
+
+#ifdef HAVE_X86_SIMD
 
-    while (i < size_arr1 && j < size_arr2 && k < size_arr3)
+__attribute__((target("avx2,popcnt")))
+static size_t advance_avx2(const int arr[], size_t n, size_t from, int target)
+{
+    if (from + 16 <= n)
     {
-        if (arr1[i] == arr2[j] && arr2[j] == arr3[k])
+        __m256i x = _mm256_set1_epi32(target);
+        __m256i lo = _mm256_cmpgt_epi32(x, _mm256_loadu_si256((const __m256i *)(arr + from)));
+        __m256i hi = _mm256_cmpgt_epi32(x, _mm256_loadu_si256((const __m256i *)(arr + from + 8)));
+        unsigned less = (unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(lo))
+                      | (unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(hi)) << 8;
+
+        // Sorted, so the elements < target are a prefix of the block
+        if (less != 0xFFFF)
         {
-            printf("%d ",arr1[i]);
-            i++ , j++ , k++;
+            return from + __builtin_popcount(less);
         }
-        else if( arr1[i] < arr2[j] )
+        from += 16;
+    }
+    return gallop(arr, n, from, target);
+}
+
+__attribute__((target("avx512f,popcnt")))
+static size_t advance_avx512(const int arr[], size_t n, size_t from, int target)
+{
+    if (from + 16 <= n)
+    {
+        __mmask16 less = _mm512_cmplt_epi32_mask(_mm512_loadu_si512((const void *)(arr + from)),
+                                                 _mm512_set1_epi32(target));
+
+        if (less != 0xFFFF)
         {
-            i++;
+            return from + __builtin_popcount(less);
         }
-        else if ( arr2[j] < arr3[k] )
+        from += 16;
+    }
+    return gallop(arr, n, from, target);
+}
+
+#endif
+
+typedef size_t (*advance_kernel)(const int *, size_t, size_t, int);
+
+static advance_kernel get_advance(void)
+{
+    static advance_kernel kernel = NULL;
+
+    if (kernel == NULL)
+    {
+        kernel = advance_scalar;
+#ifdef HAVE_X86_SIMD
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f"))
+        {
+            kernel = advance_avx512;
+        }
+        else if (__builtin_cpu_supports("avx2"))
         {
-            j++;
+            kernel = advance_avx2;
+        }
+#endif
+    }
+    return kernel;
+}
+
+// ------------------------------------------------------------------
+// Core loop
+// ------------------------------------------------------------------
+
+// Lists must already be ordered by size, smallest first. Every match goes to
+// out[] (when not NULL) and to callback (when not NULL). Returns the count.
+static size_t intersect_sorted_lists(const int *lists[], const size_t sizes[], int k,
+                                     int out[], match_callback callback, void *ctx)
+{
+    advance_kernel advance = get_advance();
+    size_t pos[KWAY_MAX_LISTS], count = 0;
+    int l;
+
+    for (l = 0; l < k; l++)
+    {
+        pos[l] = 0;
+    }
+
+    while (pos[0] < sizes[0])
+    {
+        int target = lists[0][pos[0]];
+
+        for (l = 1; l < k; l++)
+        {
+            pos[l] = advance(lists[l], sizes[l], pos[l], target);
+            if (pos[l] == sizes[l])
+            {
+                return count;
+            }
+            if (lists[l][pos[l]] != target)
+            {
+                break;
+            }
+        }
+
+        if (l == k)
+        {
+            if (out != NULL)
+            {
+                out[count] = target;
+            }
+            if (callback != NULL)
+            {
+                callback(target, ctx);
+            }
+            count++;
+            pos[0]++;
         }
         else
         {
-            k++;
+            // Nothing below lists[l][pos[l]] can match any more
+            pos[0] = advance(lists[0], sizes[0], pos[0] + 1, lists[l][pos[l]]);
+        }
+    }
+    return count;
+}
+
+// Copies the lists ordered by size (insertion sort, k is small)
+static void order_by_size(const int *lists[], const size_t sizes[], int k,
+                          const int *sorted_lists[], size_t sorted_sizes[])
+{
+    int i, j;
+
+    for (i = 0; i < k; i++)
+    {
+        const int *list = lists[i];
+        size_t size = sizes[i];
+
+        for (j = i; j > 0 && sorted_sizes[j - 1] > size; j--)
+        {
+            sorted_lists[j] = sorted_lists[j - 1];
+            sorted_sizes[j] = sorted_sizes[j - 1];
         }
-        
+        sorted_lists[j] = list;
+        sorted_sizes[j] = size;
     }
+}
+
+// Intersection of k sorted sets. out[] needs room for the smallest set and
+// may be NULL when only the callback is wanted. Returns the number of matches.
+size_t kway_intersect(const int *lists[], const size_t sizes[], int k,
+                      int out[], match_callback callback, void *ctx)
+{
+    const int *sorted_lists[KWAY_MAX_LISTS];
+    size_t sorted_sizes[KWAY_MAX_LISTS];
+
+    if (k <= 0 || k > KWAY_MAX_LISTS)
+    {
+        return 0;
+    }
+
+    order_by_size(lists, sizes, k, sorted_lists, sorted_sizes);
+    return intersect_sorted_lists(sorted_lists, sorted_sizes, k, out, callback, ctx);
+}
+
+// ------------------------------------------------------------------
+// Threaded mode
+// ------------------------------------------------------------------
+
+struct kway_slice
+{
+    const int *lists[KWAY_MAX_LISTS];
+    size_t sizes[KWAY_MAX_LISTS];
+    int k;
+    int *out;           // this slice's part of the result buffer
+    size_t count;
+};
+
+static void *kway_worker(void *arg)
+{
+    struct kway_slice *s = (struct kway_slice *)arg;
+
+    s->count = intersect_sorted_lists(s->lists, s->sizes, s->k, s->out, NULL, NULL);
+    return NULL;
+}
+
+// Same result as kway_intersect(), computed by up to `threads` threads.
+// The matches are reported in order : out[] is compacted after the threads
+// finish, then the callback (if any) is called from the calling thread.
+// Returns the number of matches, or 0 when a scratch buffer cannot be allocated.
+size_t kway_intersect_parallel(const int *lists[], const size_t sizes[], int k,
+                               int out[], match_callback callback, void *ctx, int threads)
+{
+    const int *sorted_lists[KWAY_MAX_LISTS];
+    size_t sorted_sizes[KWAY_MAX_LISTS], total = 0, chunk, i;
+    struct kway_slice *slices;
+    pthread_t tid[KWAY_MAX_THREADS];
+    int *buffer = out;
+    int t, l;
+
+    if (k <= 0 || k > KWAY_MAX_LISTS)
+    {
+        return 0;
+    }
+    order_by_size(lists, sizes, k, sorted_lists, sorted_sizes);
+
+    threads = (threads > KWAY_MAX_THREADS) ? KWAY_MAX_THREADS : threads;
+    if (threads <= 1 || sorted_sizes[0] < (size_t)threads * 1024)
+    {
+        return intersect_sorted_lists(sorted_lists, sorted_sizes, k, out, callback, ctx);
+    }
+
+    slices = (struct kway_slice *)malloc(threads * sizeof(struct kway_slice));
+    if (buffer == NULL)
+    {
+        buffer = (int *)malloc(sorted_sizes[0] * sizeof(int));
+    }
+    if (slices == NULL || buffer == NULL)
+    {
+        free(slices);
+        if (buffer != out)
+        {
+            free(buffer);
+        }
+        return 0;
+    }
+
+    // Slice t owns the keys in [smallest[begin], smallest[end])
+    chunk = (sorted_sizes[0] + threads - 1) / threads;
+    for (t = 0; t < threads; t++)
+    {
+        size_t begin = t * chunk;
+        size_t end = (begin + chunk < sorted_sizes[0]) ? begin + chunk : sorted_sizes[0];
+        struct kway_slice *s = &slices[t];
+
+        s->k = k;
+        s->out = buffer + begin;
+        s->lists[0] = sorted_lists[0] + begin;
+        s->sizes[0] = end - begin;
+
+        for (l = 1; l < k; l++)
+        {
+            size_t from = (begin < sorted_sizes[0]) ? gallop(sorted_lists[l], sorted_sizes[l], 0, sorted_lists[0][begin])
+                                                    : sorted_sizes[l];
+            size_t to = (end < sorted_sizes[0]) ? gallop(sorted_lists[l], sorted_sizes[l], 0, sorted_lists[0][end])
+                                                : sorted_sizes[l];
+
+            s->lists[l] = sorted_lists[l] + from;
+            s->sizes[l] = to - from;
+        }
+
+        if (pthread_create(&tid[t], NULL, kway_worker, s) != 0)
+        {
+            kway_worker(s);
+            tid[t] = pthread_self();
+        }
+    }
+
+    // Join in order and close the gaps between the slices' results
+    for (t = 0; t < threads; t++)
+    {
+        if (!pthread_equal(tid[t], pthread_self()))
+        {
+            pthread_join(tid[t], NULL);
+        }
+        memmove(buffer + total, slices[t].out, slices[t].count * sizeof(int));
+        total += slices[t].count;
+    }
+
+    if (callback != NULL)
+    {
+        for (i = 0; i < total; i++)
+        {
+            callback(buffer[i], ctx);
+        }
+    }
+
+    free(slices);
+    if (buffer != out)
+    {
+        free(buffer);
+    }
+    return total;
+}
+
+static void print_match(int value, void *ctx)
+{
+    (void)ctx;
+    printf("%d ", value);
+}
+
+int main()
+{
+    int arr1[] = {1, 5, 10, 20, };
+    int arr2[] = {1, 2, 4, 6, 8, 10};
+    int arr3[] = {1, 2, 3, 4, 5};
+    int arr4[] = {0, 1, 7, 10, 11, 12, 13};
+    const int *lists[] = { arr1, arr2, arr3, arr4 };
+    size_t sizes[] = { sizeof(arr1) / sizeof(arr1[0]), sizeof(arr2) / sizeof(arr2[0]),
+                       sizeof(arr3) / sizeof(arr3[0]), sizeof(arr4) / sizeof(arr4[0]) };
+
+    printf("\nCommon Elements are : ");
+    kway_intersect(lists, sizes, 3, NULL, print_match, NULL);
+
+    printf("\nCommon Elements of all four arrays are : ");
+    kway_intersect_parallel(lists, sizes, 4, NULL, print_match, NULL, 4);
     printf("\n");
 
     return 0;
-    
-}
\ No newline at end of file
+
+}
@@ -8,25 +8,315 @@
 // Explanation: 4 is not in the array.
 
 
-//Solve in linear search. --> TC : O(n) & SC : O(1)
+//Solve with two binary searches. --> TC : O(log n) & SC : O(1)
+// lower_bound finds the first element >= X and upper_bound the first element > X,
+// the count is the distance between them (equal_range).
+
+// Many targets : count_occurrences_batch() walks the sorted targets and the array
+// together, galloping from the previous answer. --> TC : O(m log(n / m))
+
+// Unsorted array : count_unsorted() compares 8 (AVX2) or 16 (AVX-512) elements
+// per instruction and popcounts the match masks. --> TC : O(n)
+
+// Compile : gcc -O2 Count_Occurrences.c -o count
+// Run     : ./count              (small example)
+//           ./count bench [logn] (linear scan vs equal_range)
 
 #include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<time.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HAVE_X86_SIMD 1
+#include <immintrin.h>
+#endif
 
-int main()
+// Index of the first element >= target, or n.
+size_t lower_bound(const int arr[], size_t n, int target)
 {
-    int arr[] = {1, 2, 2, 5, 5, 5, 5, 5, 5, 7, 8, 11, 11, 11};
-    int i, size = sizeof(arr)/sizeof(arr[0]);
+    size_t low = 0, high = n;
+
+    while (low < high)
+    {
+        size_t mid = low + (high - low) / 2;
+
+        if (arr[mid] < target)
+        {
+            low = mid + 1;
+        }
+        else
+        {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+// Index of the first element > target, or n.
+size_t upper_bound(const int arr[], size_t n, int target)
+{
+    size_t low = 0, high = n;
+
+    while (low < high)
+    {
+        size_t mid = low + (high - low) / 2;
+
+        if (arr[mid] <= target)
+        {
+            low = mid + 1;
+        }
+        else
+        {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+// All copies of target are arr[*first .. *last).
+void equal_range(const int arr[], size_t n, int target, size_t *first, size_t *last)
+{
+    *first = lower_bound(arr, n, target);
+    // The run cannot start before first, so search only the rest
+    *last = *first + upper_bound(arr + *first, n - *first, target);
+}
+
+size_t count_occurrences(const int arr[], size_t n, int target)
+{
+    size_t first, last;
+
+    equal_range(arr, n, target, &first, &last);
+    return last - first;
+}
+
+// First index >= from whose element is > target (upper = 1) or >= target,
+// galloping 1, 2, 4 ... from "from" before the binary search.
+static size_t gallop_bound(const int arr[], size_t n, size_t from, int target, int upper)
+{
+    size_t low = from, probe = from, step = 1;
+
+    while (probe < n && (upper ? arr[probe] <= target : arr[probe] < target))
+    {
+        low = probe + 1;
+        probe = low + step - 1;
+        step *= 2;
+    }
+    if (probe > n)
+    {
+        probe = n;
+    }
+
+    return low + (upper ? upper_bound(arr + low, probe - low, target)
+                        : lower_bound(arr + low, probe - low, target));
+}
+
+// Counts of many targets in one merged pass. counts[i] receives the count of
+// targets[i]. Targets should be sorted ; an out of order target restarts the
+// walk from the beginning of the array, so the result is still correct.
+void count_occurrences_batch(const int arr[], size_t n, const int targets[], size_t m, size_t counts[])
+{
+    size_t pos = 0, i;
+
+    for (i = 0; i < m; i++)
+    {
+        size_t first, last;
+
+        if (i > 0 && targets[i] < targets[i - 1])
+        {
+            pos = 0;
+        }
+
+        first = gallop_bound(arr, n, pos, targets[i], 0);
+        last = gallop_bound(arr, n, first, targets[i], 1);
+        counts[i] = last - first;
+        // Not last : a repeated target must find the same run again
+        pos = first;
+    }
+}
+
+// ------------------------------------------------------------------
+// Unsorted input : SIMD compare and popcount
+// ------------------------------------------------------------------
+
+static size_t count_unsorted_scalar(const int arr[], size_t n, int target)
+{
+    size_t i, count = 0;
+
+    for (i = 0; i < n; i++)
+    {
+        count += (arr[i] == target);
+    }
+    return count;
+}
+
+#ifdef HAVE_X86_SIMD
+
+__attribute__((target("avx2,popcnt")))
+static size_t count_unsorted_avx2(const int arr[], size_t n, int target)
+{
+    __m256i x = _mm256_set1_epi32(target);
+    size_t i = 0, count = 0;
+
+    for (; i + 32 <= n; i += 32)
+    {
+        __m256i m0 = _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i *)(arr + i)), x);
+        __m256i m1 = _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i *)(arr + i + 8)), x);
+        __m256i m2 = _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i *)(arr + i + 16)), x);
+        __m256i m3 = _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i *)(arr + i + 24)), x);
+        unsigned mask = (unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(m0))
+                      | (unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(m1)) << 8
+                      | (unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(m2)) << 16
+                      | (unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(m3)) << 24;
+
+        count += __builtin_popcount(mask);
+    }
+    return count + count_unsorted_scalar(arr + i, n - i, target);
+}
+
+__attribute__((target("avx512f,popcnt")))
+static size_t count_unsorted_avx512(const int arr[], size_t n, int target)
+{
+    __m512i x = _mm512_set1_epi32(target);
+    size_t i = 0, count = 0;
 
-    int target_num = 5, count = 0;
+    for (; i + 64 <= n; i += 64)
+    {
+        unsigned long long mask =
+              (unsigned long long)_mm512_cmpeq_epi32_mask(_mm512_loadu_si512((const void *)(arr + i)), x)
+            | (unsigned long long)_mm512_cmpeq_epi32_mask(_mm512_loadu_si512((const void *)(arr + i + 16)), x) << 16
+            | (unsigned long long)_mm512_cmpeq_epi32_mask(_mm512_loadu_si512((const void *)(arr + i + 32)), x) << 32
+            | (unsigned long long)_mm512_cmpeq_epi32_mask(_mm512_loadu_si512((const void *)(arr + i + 48)), x) << 48;
+
+        count += __builtin_popcountll(mask);
+    }
+    return count + count_unsorted_scalar(arr + i, n - i, target);
+}
+
+#endif
 
-    for ( i = 0; i < size; i++)
+// Number of copies of target in an unsorted array
+size_t count_unsorted(const int arr[], size_t n, int target)
+{
+    static size_t (*kernel)(const int *, size_t, int) = NULL;
+
+    if (kernel == NULL)
     {
-        if (arr[i] == target_num)
+        kernel = count_unsorted_scalar;
+#ifdef HAVE_X86_SIMD
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f"))
         {
-            count++;
+            kernel = count_unsorted_avx512;
         }
-        
+        else if (__builtin_cpu_supports("avx2"))
+        {
+            kernel = count_unsorted_avx2;
+        }
+#endif
+    }
+    return kernel(arr, n, target);
+}
+
+// ------------------------------------------------------------------
+// Benchmark
+// ------------------------------------------------------------------
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void run_benchmark(int log_n)
+{
+    size_t n = (size_t)1 << log_n, queries = 1 << 20, i, total[3] = {0, 0, 0};
+    size_t scans = 8;
+    int *arr = (int *)malloc(n * sizeof(int));
+    int *targets = (int *)malloc(queries * sizeof(int));
+    size_t *counts = (size_t *)malloc(queries * sizeof(size_t));
+    double t0, t_scan, t_range, t_batch;
+
+    if (arr == NULL || targets == NULL || counts == NULL)
+    {
+        printf("Out of memory.\n");
+        free(arr);
+        free(targets);
+        free(counts);
+        return;
+    }
+
+    // Sorted, 0 to 16 copies of every value (8 on average)
+    for (i = 0; i < n; i++)
+    {
+        arr[i] = (int)(i / 8 + (i * 2654435761u >> 29) % 2);
     }
+    for (i = 1; i < n; i++)
+    {
+        arr[i] = (arr[i] < arr[i - 1]) ? arr[i - 1] : arr[i];
+    }
+    for (i = 0; i < queries; i++)
+    {
+        targets[i] = (int)(i * (n / 8) / queries);
+    }
+
+    t0 = now_seconds();
+    for (i = 0; i < scans; i++)
+    {
+        total[0] += count_unsorted(arr, n, targets[i * queries / scans]);
+    }
+    t_scan = (now_seconds() - t0) / scans;
+
+    t0 = now_seconds();
+    for (i = 0; i < queries; i++)
+    {
+        total[1] += count_occurrences(arr, n, targets[i]);
+    }
+    t_range = (now_seconds() - t0) / queries;
+
+    t0 = now_seconds();
+    count_occurrences_batch(arr, n, targets, queries, counts);
+    t_batch = (now_seconds() - t0) / queries;
+    for (i = 0; i < queries; i++)
+    {
+        total[2] += counts[i];
+    }
+
+    printf("n = %zu\n", n);
+    printf("  SIMD full scan : %12.1f ns / query (total %zu)\n", t_scan * 1e9, total[0]);
+    printf("  equal_range    : %12.1f ns / query\n", t_range * 1e9);
+    printf("  merged batch   : %12.1f ns / query (totals %zu %zu)\n", t_batch * 1e9, total[1], total[2]);
+
+    free(arr);
+    free(targets);
+    free(counts);
+}
+
+int main(int argc, char *argv[])
+{
+    int arr[] = {1, 2, 2, 5, 5, 5, 5, 5, 5, 7, 8, 11, 11, 11};
+    int targets[] = {2, 5, 5, 6, 11, 11};
+    size_t i, size = sizeof(arr)/sizeof(arr[0]), m = sizeof(targets)/sizeof(targets[0]), counts[6];
+
+    int target_num = 5, count;
+
+    if (argc > 1 && strcmp(argv[1], "bench") == 0)
+    {
+        run_benchmark(argc > 2 ? atoi(argv[2]) : 26);
+        return 0;
+    }
+
+    count = (int)count_occurrences(arr, size, target_num);
     printf("\nThe %d ocurrs %d times in this array.", target_num, count);
+
+    count_occurrences_batch(arr, size, targets, m, counts);
+    printf("\nCounts of 2, 5, 5, 6, 11, 11 : ");
+    for (i = 0; i < m; i++)
+    {
+        printf("%zu ", counts[i]);
+    }
+    printf("\nUnsorted count of 11 : %zu\n", count_unsorted(arr, size, 11));
     return 0;
-}
\ No newline at end of file
+}
@@ -2,29 +2,488 @@
 // Solve the problem in space complexity O(1) and time complexity O(n).
 // The array always be sorted order
 
+// Input : arr[] = {1, 2, 4, 4, 5, 6, 6, 7}
+// Output : The solving array is : 1 2 4 5 6 7
+
+// An element survives when it differs from the element before it. The test is
+// done for 8 (AVX2) or 16 (AVX-512) elements at once : the block is compared
+// with itself shifted by one lane, and the survivors are packed to the front
+// with a compress store (AVX-512) or a permute from a 256-entry shuffle table
+// (AVX2). The write position never passes the read position, so it works in
+// place.
+// The same compaction removes the elements matching a predicate (equal to a
+// value, inside or outside a range) : remove_if(). remove_if_callback() takes
+// any predicate function but stays scalar.
+// The _parallel versions cut the array in one block per thread. Each block is
+// compacted on its own, then the blocks are moved next to each other ; for
+// dedup a block whose first survivor equals the previous block's last one
+// drops it (the boundary fixup).
+
+// Time Complexity : O(n)
+// Space Complexity : O(1)
+
+// Compile : gcc -O2 -pthread Duplicate_Remove.c -o dedup
+// Run     : ./dedup              (small example)
+//           ./dedup bench [logn] (GB/s of scalar, SIMD and threaded dedup)
+
 #include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<time.h>
+#include<pthread.h>
+#include<unistd.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HAVE_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+#define MAX_THREADS 64
 
-int main()
+// Smallest block worth a thread
+#define MIN_BLOCK (1 << 16)
+
+enum remove_kind
 {
-    int arr[20] = {1, 2, 4, 4, 5, 6, 6, 7};
-    int i, x = 0, n = 8;
+    REMOVE_EQUAL,       // x == low
+    REMOVE_BETWEEN,     // low <= x <= high
+    REMOVE_OUTSIDE      // x < low or x > high
+};
+
+struct remove_predicate
+{
+    enum remove_kind kind;
+    int low, high;
+};
+
+// A NULL predicate means "remove the element equal to its predecessor"
+static int must_remove(const struct remove_predicate *pred, int x, int previous)
+{
+    if (pred == NULL)
+    {
+        return x == previous;
+    }
+    switch (pred->kind)
+    {
+    case REMOVE_EQUAL:
+        return x == pred->low;
+    case REMOVE_BETWEEN:
+        return x >= pred->low && x <= pred->high;
+    default:
+        return x < pred->low || x > pred->high;
+    }
+}
+
+// ------------------------------------------------------------------
+// Kernels : compact arr[from .. n) behind arr[0 .. out), return the new size
+// ------------------------------------------------------------------
+
+static size_t compact_scalar_from(int arr[], size_t n, size_t from, size_t out,
+                                  const struct remove_predicate *pred)
+{
+    size_t i;
+
+    for (i = from; i < n; i++)
+    {
+        int x = arr[i];
+
+        // For dedup the last survivor has the value of the previous element,
+        // and the first element always survives
+        if ((pred == NULL && out == 0) || !must_remove(pred, x, out > 0 ? arr[out - 1] : 0))
+        {
+            arr[out++] = x;
+        }
+    }
+    return out;
+}
+
+static size_t compact_scalar(int arr[], size_t n, const struct remove_predicate *pred)
+{
+    return compact_scalar_from(arr, n, 0, 0, pred);
+}
+
+#ifdef HAVE_X86_SIMD
+
+// shuffle_table[mask] moves the lanes selected by mask to the front
+static int shuffle_table[256][8];
+
+static void build_shuffle_table(void)
+{
+    int mask, lane;
+
+    for (mask = 0; mask < 256; mask++)
+    {
+        int k = 0;
+
+        for (lane = 0; lane < 8; lane++)
+        {
+            if (mask & (1 << lane))
+            {
+                shuffle_table[mask][k++] = lane;
+            }
+        }
+        while (k < 8)
+        {
+            shuffle_table[mask][k++] = 0;
+        }
+    }
+}
+
+__attribute__((target("avx2,popcnt")))
+static size_t compact_avx2(int arr[], size_t n, const struct remove_predicate *pred)
+{
+    const __m256i last_first = _mm256_setr_epi32(7, 0, 1, 2, 3, 4, 5, 6);
+    __m256i low = _mm256_set1_epi32(pred ? pred->low : 0);
+    __m256i high = _mm256_set1_epi32(pred ? pred->high : 0);
+    __m256i prev = _mm256_setzero_si256();
+    size_t i = 0, out = 0;
+
+    if (n == 0)
+    {
+        return 0;
+    }
+    if (pred == NULL)
+    {
+        // The first element always survives a dedup
+        prev = _mm256_set1_epi32(arr[0]);
+        i = out = 1;
+    }
+
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256i cur = _mm256_loadu_si256((const __m256i *)(arr + i));
+        __m256i removed, idx;
+        unsigned keep;
+
+        if (pred == NULL)
+        {
+            // [prev[7], cur[0] .. cur[6]]
+            __m256i shifted = _mm256_blend_epi32(_mm256_permutevar8x32_epi32(cur, last_first),
+                                                 _mm256_permutevar8x32_epi32(prev, last_first), 0x01);
+
+            removed = _mm256_cmpeq_epi32(cur, shifted);
+            prev = cur;
+        }
+        else if (pred->kind == REMOVE_EQUAL)
+        {
+            removed = _mm256_cmpeq_epi32(cur, low);
+        }
+        else
+        {
+            __m256i outside = _mm256_or_si256(_mm256_cmpgt_epi32(low, cur), _mm256_cmpgt_epi32(cur, high));
+
+            removed = (pred->kind == REMOVE_OUTSIDE) ? outside
+                                                     : _mm256_xor_si256(outside, _mm256_set1_epi32(-1));
+        }
+
+        keep = ~(unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(removed)) & 0xFF;
+        idx = _mm256_loadu_si256((const __m256i *)shuffle_table[keep]);
+
+        // Writes 8 lanes, the ones past popcount are overwritten later.
+        // out + 8 <= i + 8, so nothing unread is touched.
+        _mm256_storeu_si256((__m256i *)(arr + out), _mm256_permutevar8x32_epi32(cur, idx));
+        out += __builtin_popcount(keep);
+    }
+
+    return compact_scalar_from(arr, n, i, out, pred);
+}
+
+__attribute__((target("avx512f,popcnt")))
+static size_t compact_avx512(int arr[], size_t n, const struct remove_predicate *pred)
+{
+    __m512i low = _mm512_set1_epi32(pred ? pred->low : 0);
+    __m512i high = _mm512_set1_epi32(pred ? pred->high : 0);
+    __m512i prev = _mm512_setzero_si512();
+    size_t i = 0, out = 0;
 
-    for ( i = 1; i < n; i++)
+    if (n == 0)
     {
-        if (arr[i] != arr[x])
+        return 0;
+    }
+    if (pred == NULL)
+    {
+        prev = _mm512_set1_epi32(arr[0]);
+        i = out = 1;
+    }
+
+    for (; i + 16 <= n; i += 16)
+    {
+        __m512i cur = _mm512_loadu_si512((const void *)(arr + i));
+        __mmask16 keep;
+
+        if (pred == NULL)
         {
-            x += 1;
-            arr[x] = arr[i];
+            // [prev[15], cur[0] .. cur[14]]
+            keep = _mm512_cmpneq_epi32_mask(cur, _mm512_alignr_epi32(cur, prev, 15));
+            prev = cur;
         }
-        
+        else if (pred->kind == REMOVE_EQUAL)
+        {
+            keep = _mm512_cmpneq_epi32_mask(cur, low);
+        }
+        else if (pred->kind == REMOVE_BETWEEN)
+        {
+            keep = _mm512_cmplt_epi32_mask(cur, low) | _mm512_cmpgt_epi32_mask(cur, high);
+        }
+        else
+        {
+            keep = _mm512_cmpge_epi32_mask(cur, low) & _mm512_cmple_epi32_mask(cur, high);
+        }
+
+        _mm512_mask_compressstoreu_epi32(arr + out, keep, cur);
+        out += __builtin_popcount(keep);
     }
 
+    return compact_scalar_from(arr, n, i, out, pred);
+}
+
+#endif
+
+typedef size_t (*compact_kernel)(int *, size_t, const struct remove_predicate *);
+
+static compact_kernel get_kernel(void)
+{
+    static compact_kernel kernel = NULL;
+
+    if (kernel == NULL)
+    {
+        kernel = compact_scalar;
+#ifdef HAVE_X86_SIMD
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f"))
+        {
+            kernel = compact_avx512;
+        }
+        else if (__builtin_cpu_supports("avx2"))
+        {
+            build_shuffle_table();
+            kernel = compact_avx2;
+        }
+#endif
+    }
+    return kernel;
+}
+
+// Removes the repeated values of a sorted array (any array : runs of equal
+// neighbours are collapsed). Returns the new size.
+size_t dedup_sorted(int arr[], size_t n)
+{
+    return get_kernel()(arr, n, NULL);
+}
+
+// Removes the elements matching pred, keeping the order. Returns the new size.
+size_t remove_if(int arr[], size_t n, const struct remove_predicate *pred)
+{
+    return get_kernel()(arr, n, pred);
+}
+
+// Same with any predicate function (nonzero = remove), one element at a time
+size_t remove_if_callback(int arr[], size_t n, int (*pred)(int value, void *ctx), void *ctx)
+{
+    size_t i, out = 0;
+
+    for (i = 0; i < n; i++)
+    {
+        int x = arr[i];
+
+        arr[out] = x;
+        out += !pred(x, ctx);
+    }
+    return out;
+}
+
+// ------------------------------------------------------------------
+// Threaded block mode
+// ------------------------------------------------------------------
+
+struct compact_block
+{
+    int *arr;
+    size_t n;
+    const struct remove_predicate *pred;
+    size_t kept;
+};
+
+static void *compact_worker(void *arg)
+{
+    struct compact_block *b = (struct compact_block *)arg;
+
+    b->kept = get_kernel()(b->arr, b->n, b->pred);
+    return NULL;
+}
+
+static size_t compact_parallel(int arr[], size_t n, const struct remove_predicate *pred, int threads)
+{
+    struct compact_block blocks[MAX_THREADS];
+    pthread_t tid[MAX_THREADS];
+    int started[MAX_THREADS];
+    size_t chunk, out = 0;
+    int t;
+
+    if (threads > MAX_THREADS)
+    {
+        threads = MAX_THREADS;
+    }
+    if ((size_t)threads > n / MIN_BLOCK)
+    {
+        threads = (int)(n / MIN_BLOCK);
+    }
+    if (threads <= 1)
+    {
+        return get_kernel()(arr, n, pred);
+    }
+
+    // Builds the CPU dispatch once, before the threads race on it
+    get_kernel();
+
+    chunk = (n + threads - 1) / threads;
+    for (t = 0; t < threads; t++)
+    {
+        size_t begin = t * chunk;
+
+        blocks[t].arr = arr + begin;
+        blocks[t].n = (begin + chunk < n) ? chunk : n - begin;
+        blocks[t].pred = pred;
+        started[t] = (pthread_create(&tid[t], NULL, compact_worker, &blocks[t]) == 0);
+        if (!started[t])
+        {
+            compact_worker(&blocks[t]);
+        }
+    }
+
+    for (t = 0; t < threads; t++)
+    {
+        const int *first = blocks[t].arr;
+        size_t kept;
+
+        if (started[t])
+        {
+            pthread_join(tid[t], NULL);
+        }
+        kept = blocks[t].kept;
+
+        // Boundary fixup : the run may continue from the previous block
+        if (pred == NULL && out > 0 && kept > 0 && first[0] == arr[out - 1])
+        {
+            first++;
+            kept--;
+        }
+
+        memmove(arr + out, first, kept * sizeof(int));
+        out += kept;
+    }
+    return out;
+}
+
+size_t dedup_sorted_parallel(int arr[], size_t n, int threads)
+{
+    return compact_parallel(arr, n, NULL, threads);
+}
+
+size_t remove_if_parallel(int arr[], size_t n, const struct remove_predicate *pred, int threads)
+{
+    return compact_parallel(arr, n, pred, threads);
+}
+
+// ------------------------------------------------------------------
+// Benchmark
+// ------------------------------------------------------------------
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static unsigned long long rng_state = 88172645463325252ULL;
+
+static unsigned long long next_random(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return rng_state;
+}
+
+static void run_benchmark(int log_n)
+{
+    size_t n = (size_t)1 << log_n, i, kept[3];
+    int threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    int *source = (int *)malloc(n * sizeof(int));
+    int *arr = (int *)malloc(n * sizeof(int));
+    double t0, t[3];
+
+    if (source == NULL || arr == NULL)
+    {
+        printf("Out of memory.\n");
+        free(source);
+        free(arr);
+        return;
+    }
+
+    // Sorted, about half of the elements repeat the previous one
+    source[0] = 0;
+    for (i = 1; i < n; i++)
+    {
+        source[i] = source[i - 1] + (int)(next_random() & 1);
+    }
+
+    memcpy(arr, source, n * sizeof(int));
+    t0 = now_seconds();
+    kept[0] = compact_scalar(arr, n, NULL);
+    t[0] = now_seconds() - t0;
+
+    memcpy(arr, source, n * sizeof(int));
+    t0 = now_seconds();
+    kept[1] = dedup_sorted(arr, n);
+    t[1] = now_seconds() - t0;
+
+    memcpy(arr, source, n * sizeof(int));
+    t0 = now_seconds();
+    kept[2] = dedup_sorted_parallel(arr, n, threads);
+    t[2] = now_seconds() - t0;
+
+    printf("n = %zu, %zu distinct\n", n, kept[0]);
+    printf("  scalar             : %6.2f GB/s\n", n * sizeof(int) / t[0] * 1e-9);
+    printf("  SIMD               : %6.2f GB/s (%zu)\n", n * sizeof(int) / t[1] * 1e-9, kept[1]);
+    printf("  SIMD, %2d thread(s) : %6.2f GB/s (%zu)\n", threads, n * sizeof(int) / t[2] * 1e-9, kept[2]);
+
+    free(source);
+    free(arr);
+}
+
+int main(int argc, char *argv[])
+{
+    int arr[20] = {1, 2, 4, 4, 5, 6, 6, 7};
+    int other[] = {3, 8, 1, 9, 4, 12, 7, 5, 10};
+    struct remove_predicate pred = { REMOVE_BETWEEN, 4, 8 };
+    size_t i, n = 8;
+
+    if (argc > 1 && strcmp(argv[1], "bench") == 0)
+    {
+        run_benchmark(argc > 2 ? atoi(argv[2]) : 26);
+        return 0;
+    }
+
+    n = dedup_sorted(arr, n);
+
     printf("The solving array is : ");
-    for ( i = 0; i <= x; i++)
+    for ( i = 0; i < n; i++)
     {
         printf("%d ",arr[i]);
     }
-    
+
+    n = remove_if(other, sizeof(other) / sizeof(other[0]), &pred);
+
+    printf("\nWithout the values in [4, 8] : ");
+    for ( i = 0; i < n; i++)
+    {
+        printf("%d ",other[i]);
+    }
+    printf("\n");
+
     return 0;
-    
-}
\ No newline at end of file
+
+}
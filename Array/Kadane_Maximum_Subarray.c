@@ -0,0 +1,353 @@
+// Maximum sum subarray of any length (Kadane's algorithm).
+
+// Input : arr[] = {-2, 1, -3, 4, -1, 2, 1, -5, 4}
+// Output : The maximum sum = 6, the sub array is : 4 -1 2 1
+
+// Kadane : walking left to right, the best subarray ending at i is either
+// arr[i] alone or arr[i] added to the best one ending at i - 1.
+// The same pass also gives a summary of the whole range :
+//  - total   : sum of the range
+//  - prefix  : best sum starting at the first element
+//  - suffix  : best sum ending at the last element
+//  - best    : best sum anywhere (Kadane)
+// Two neighbouring summaries L, R combine in O(1) :
+//  - total  = L.total + R.total
+//  - prefix = max(L.prefix, L.total + R.prefix)
+//  - suffix = max(R.suffix, L.suffix + R.total)
+//  - best   = max(L.best, R.best, L.suffix + R.prefix)
+// So max_subarray_parallel() gives every thread one chunk, and the summaries
+// are merged in a tree : thread t waits for thread t + 1, t + 2, t + 4 ...
+// while the low bits of t are zero, then thread 0 holds the answer.
+// Sums use 64-bit accumulators, ranges are returned as [start, end).
+// Ties go to the earliest end, then to the latest start (what Kadane's
+// restart on current <= 0 picks), in the pass and in the merge alike.
+
+// Time Complexity : O(n / threads + log threads)
+// Space Complexity : O(threads)
+
+// Compile : gcc -O2 -pthread Kadane_Maximum_Subarray.c -o kadane
+// Run     : ./kadane              (small example)
+//           ./kadane bench [logn] (serial against threaded)
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<limits.h>
+#include<time.h>
+#include<pthread.h>
+#include<unistd.h>
+
+#define MAX_THREADS 64
+
+// Smallest chunk worth a thread
+#define MIN_CHUNK (1 << 16)
+
+struct subarray_summary
+{
+    long long total;
+    long long prefix;           // sum of arr[begin .. prefix_end)
+    size_t prefix_end;
+    long long suffix;           // sum of arr[suffix_start .. end)
+    size_t suffix_start;
+    long long best;             // sum of arr[best_start .. best_end)
+    size_t best_start, best_end;
+};
+
+// One pass over arr[begin .. end), end > begin. Indices are absolute.
+static void summarize(const int arr[], size_t begin, size_t end, struct subarray_summary *s)
+{
+    long long running = 0, min_before = 0, current = 0;
+    size_t min_at = begin, current_start = begin, i;
+
+    s->prefix = s->best = LLONG_MIN;
+    s->prefix_end = s->best_start = s->best_end = begin;
+
+    for (i = begin; i < end; i++)
+    {
+        long long x = arr[i];
+
+        // Suffix from i = total - sum(arr[begin .. i)), so keep the smallest
+        // (the latest one on ties)
+        if (running <= min_before)
+        {
+            min_before = running;
+            min_at = i;
+        }
+        running += x;
+
+        if (running > s->prefix)
+        {
+            s->prefix = running;
+            s->prefix_end = i + 1;
+        }
+
+        if (current <= 0)
+        {
+            current = x;
+            current_start = i;
+        }
+        else
+        {
+            current += x;
+        }
+        if (current > s->best)
+        {
+            s->best = current;
+            s->best_start = current_start;
+            s->best_end = i + 1;
+        }
+    }
+
+    s->total = running;
+    s->suffix = running - min_before;
+    s->suffix_start = min_at;
+}
+
+// left becomes the summary of left followed by right
+static void combine(struct subarray_summary *left, const struct subarray_summary *right)
+{
+    long long cross = left->suffix + right->prefix;
+
+    // left->best ends first, so it only loses to a bigger sum. Between the
+    // two ending in right, the earlier end wins, then right->best (later start).
+    if (right->best > cross || (right->best == cross && right->best_end <= right->prefix_end))
+    {
+        if (right->best > left->best)
+        {
+            left->best = right->best;
+            left->best_start = right->best_start;
+            left->best_end = right->best_end;
+        }
+    }
+    else if (cross > left->best)
+    {
+        left->best = cross;
+        left->best_start = left->suffix_start;
+        left->best_end = right->prefix_end;
+    }
+
+    if (left->total + right->prefix > left->prefix)
+    {
+        left->prefix = left->total + right->prefix;
+        left->prefix_end = right->prefix_end;
+    }
+
+    if (left->suffix + right->total > right->suffix)
+    {
+        left->suffix += right->total;
+    }
+    else
+    {
+        left->suffix = right->suffix;
+        left->suffix_start = right->suffix_start;
+    }
+
+    left->total += right->total;
+}
+
+// Best sum of a non-empty subarray, which is arr[*start .. *end).
+// For n = 0 it returns 0 with an empty range.
+long long max_subarray(const int arr[], size_t n, size_t *start, size_t *end)
+{
+    struct subarray_summary s;
+
+    if (n == 0)
+    {
+        *start = *end = 0;
+        return 0;
+    }
+
+    summarize(arr, 0, n, &s);
+    *start = s.best_start;
+    *end = s.best_end;
+    return s.best;
+}
+
+// ------------------------------------------------------------------
+// Threaded version
+// ------------------------------------------------------------------
+
+struct kadane_job
+{
+    const int *arr;
+    size_t n;
+    int threads;
+    pthread_t tid[MAX_THREADS];
+    int started[MAX_THREADS];
+    struct subarray_summary summary[MAX_THREADS];
+};
+
+struct kadane_task
+{
+    struct kadane_job *job;
+    int t;
+};
+
+static void *kadane_worker(void *arg)
+{
+    struct kadane_task *task = (struct kadane_task *)arg;
+    struct kadane_job *job = task->job;
+    int t = task->t, step;
+    size_t chunk = (job->n + job->threads - 1) / job->threads;
+    size_t begin = t * chunk;
+    size_t end = (begin + chunk < job->n) ? begin + chunk : job->n;
+
+    summarize(job->arr, begin, end, &job->summary[t]);
+
+    // Tree reduction : absorb the neighbour at distance 1, 2, 4 ...
+    for (step = 1; step < job->threads; step *= 2)
+    {
+        if (t & step)
+        {
+            break;
+        }
+        if (t + step < job->threads)
+        {
+            if (job->started[t + step])
+            {
+                pthread_join(job->tid[t + step], NULL);
+            }
+            combine(&job->summary[t], &job->summary[t + step]);
+        }
+    }
+    return NULL;
+}
+
+// Same result as max_subarray(), computed by up to `threads` threads.
+// Returns 0 with an empty range for n = 0, or when memory runs out.
+long long max_subarray_parallel(const int arr[], size_t n, int threads, size_t *start, size_t *end)
+{
+    struct kadane_job *job;
+    struct kadane_task tasks[MAX_THREADS];
+    long long best;
+    int t;
+
+    if (threads > MAX_THREADS)
+    {
+        threads = MAX_THREADS;
+    }
+    if ((size_t)threads > n / MIN_CHUNK)
+    {
+        threads = (int)(n / MIN_CHUNK);
+    }
+    if (threads <= 1)
+    {
+        return max_subarray(arr, n, start, end);
+    }
+
+    job = (struct kadane_job *)malloc(sizeof(struct kadane_job));
+    if (job == NULL)
+    {
+        *start = *end = 0;
+        return 0;
+    }
+    job->arr = arr;
+    job->n = n;
+    job->threads = threads;
+
+    // Highest first, so every thread only joins threads that already exist.
+    // A thread that cannot be created runs here and is not joined.
+    for (t = threads - 1; t >= 1; t--)
+    {
+        tasks[t].job = job;
+        tasks[t].t = t;
+        job->started[t] = (pthread_create(&job->tid[t], NULL, kadane_worker, &tasks[t]) == 0);
+        if (!job->started[t])
+        {
+            kadane_worker(&tasks[t]);
+        }
+    }
+    tasks[0].job = job;
+    tasks[0].t = 0;
+    kadane_worker(&tasks[0]);
+
+    best = job->summary[0].best;
+    *start = job->summary[0].best_start;
+    *end = job->summary[0].best_end;
+    free(job);
+    return best;
+}
+
+// ------------------------------------------------------------------
+// Benchmark
+// ------------------------------------------------------------------
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static unsigned long long rng_state = 88172645463325252ULL;
+
+static unsigned long long next_random(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return rng_state;
+}
+
+static void run_benchmark(int log_n)
+{
+    size_t n = (size_t)1 << log_n, i, start[2], end[2];
+    int threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    int *arr = (int *)malloc(n * sizeof(int));
+    long long best[2];
+    double t0, t[2];
+
+    if (arr == NULL)
+    {
+        printf("Out of memory.\n");
+        return;
+    }
+
+    // Values in [-1000, 1000]
+    for (i = 0; i < n; i++)
+    {
+        arr[i] = (int)(next_random() % 2001) - 1000;
+    }
+
+    t0 = now_seconds();
+    best[0] = max_subarray(arr, n, &start[0], &end[0]);
+    t[0] = now_seconds() - t0;
+
+    t0 = now_seconds();
+    best[1] = max_subarray_parallel(arr, n, threads, &start[1], &end[1]);
+    t[1] = now_seconds() - t0;
+
+    printf("n = %zu\n", n);
+    printf("  serial             : %6.2f GB/s, sum %lld in [%zu, %zu)\n",
+           n * sizeof(int) / t[0] * 1e-9, best[0], start[0], end[0]);
+    printf("  %2d thread(s)       : %6.2f GB/s, sum %lld in [%zu, %zu)\n",
+           threads, n * sizeof(int) / t[1] * 1e-9, best[1], start[1], end[1]);
+
+    free(arr);
+}
+
+int main(int argc, char *argv[])
+{
+    int arr[] = {-2, 1, -3, 4, -1, 2, 1, -5, 4};
+    size_t i, start, end, n = sizeof(arr) / sizeof(arr[0]);
+    long long max;
+
+    if (argc > 1 && strcmp(argv[1], "bench") == 0)
+    {
+        run_benchmark(argc > 2 ? atoi(argv[2]) : 26);
+        return 0;
+    }
+
+    max = max_subarray(arr, n, &start, &end);
+
+    printf("\nThe maximum sum = %lld ", max);
+    printf("\nThe sub array is : ");
+    for (i = start; i < end; i++)
+    {
+        printf("%d ", arr[i]);
+    }
+    printf("\n");
+
+    return 0;
+}
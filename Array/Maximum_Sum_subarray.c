@@ -1,4 +1,7 @@
 // Using Naive Approch
+// Maximum sum of a fixed size window. For the best subarray of any length
+// (Kadane, serial and threaded) see Kadane_Maximum_Subarray.c ; with the prefix
+// sums of Operations/Prefix_Sum.c every window sum is one subtraction.
 
 #include<stdio.h>
 
@@ -6,26 +6,525 @@
 // The first N netural numbers sum calculate formula :
 // Sum = (n * (n + 1)) / 2;
 
-// Time Complexity : O(n) and Space complexity : O(1).
+// Generalized to every missing value of [lo, hi], reported as ranges (gaps),
+// for ID lists of any size, in memory, streamed in chunks, or in a file.
+//  - Bitmap : one bit per value of [lo, hi]. Every ID sets its bit (the
+//    threads share the bitmap and set bits with an atomic OR), then the
+//    bitmap is walked 64 values at a time : full words are skipped, and in
+//    the other ones the gap starts and ends are the edges of the runs of
+//    zero bits, found with a shift and a count-trailing-zeros.
+//  - Fast path, 1 or 2 missing values : find_gaps() tries it first when the
+//    caller vouches the IDs are distinct and the count says so. With one
+//    missing, the XOR of the range against the XOR of the IDs gives it, and
+//    the sums (mod 2^64, no overflow) must agree. With two, a + b comes from
+//    the sums and a second pass sums the IDs below (a + b) / 2, which is
+//    only a. O(1) memory. When the checks do not add up, the bitmap is used.
+// Sums and counts are unsigned 64-bit, the old int version overflowed past
+// about 46,000 values.
+// For a sorted list of int IDs asked about slice by slice, range_sums_build()
+// of Operations/Prefix_Sum.c gives the sum of any slice in O(1). Subtracted
+// from the sum of the values the slice spans, that is the missing value of a
+// slice missing one. The 64-bit IDs here are past its int input.
 
+// Time Complexity : O(n + (hi - lo) / 64)
+// Space Complexity : (hi - lo + 1) / 8 bytes, O(1) on the fast path
+
+// Compile : gcc -O2 -pthread Missing_Number.c -o missing
+// Run     : ./missing                  (small example)
+//           ./missing file <path> <lo> <hi> (gaps of a file of 64-bit IDs)
+//           ./missing bench [logn]     (IDs per second)
 
 #include<stdio.h>
-int main()
+#include<stdlib.h>
+#include<string.h>
+#include<time.h>
+#include<pthread.h>
+#include<unistd.h>
+#include<fcntl.h>
+#include<sys/mman.h>
+#include<sys/stat.h>
+
+#define MAX_THREADS 64
+
+// Smallest chunk of IDs worth a thread
+#define MIN_CHUNK (1 << 16)
+
+// Missing values [first, last]
+struct gap
+{
+    unsigned long long first, last;
+};
+
+struct gap_finder
+{
+    unsigned long long lo, hi;
+    unsigned long long *bits;   // bit v - lo is set once v was seen
+    size_t words;
+};
+
+// ------------------------------------------------------------------
+// Bitmap
+// ------------------------------------------------------------------
+
+// Finder for [lo, hi]. Returns NULL when lo > hi or memory runs out.
+struct gap_finder *gap_finder_create(unsigned long long lo, unsigned long long hi)
+{
+    struct gap_finder *f;
+
+    if (lo > hi || hi - lo >= (unsigned long long)(size_t)-1 - 64)
+    {
+        return NULL;
+    }
+    f = (struct gap_finder *)malloc(sizeof(struct gap_finder));
+    if (f == NULL)
+    {
+        return NULL;
+    }
+    f->lo = lo;
+    f->hi = hi;
+    f->words = (size_t)((hi - lo) / 64 + 1);
+    f->bits = (unsigned long long *)calloc(f->words, sizeof(unsigned long long));
+    if (f->bits == NULL)
+    {
+        free(f);
+        return NULL;
+    }
+    return f;
+}
+
+void gap_finder_free(struct gap_finder *f)
 {
-    int arr[] = {1, 2, 3, 4, 6, 7, 8};
-    int size = sizeof(arr)/sizeof(arr[0]) + 1;
+    if (f != NULL)
+    {
+        free(f->bits);
+        free(f);
+    }
+}
 
-    int total_sum = ( size * ( size + 1)) / 2;
-    int i, actual_sum = 0 , missing_number;
+// IDs outside [lo, hi] are ignored
+static void mark(struct gap_finder *f, const unsigned long long ids[], size_t n, int shared)
+{
+    unsigned long long lo = f->lo, span = f->hi - f->lo;
+    size_t i;
 
-    for(i = 0; i < size - 1; i++)
+    for (i = 0; i < n; i++)
     {
-        actual_sum += arr[i];
+        unsigned long long v = ids[i] - lo;
+
+        if (v <= span)
+        {
+            if (shared)
+            {
+                __atomic_fetch_or(&f->bits[v / 64], 1ULL << (v % 64), __ATOMIC_RELAXED);
+            }
+            else
+            {
+                f->bits[v / 64] |= 1ULL << (v % 64);
+            }
+        }
     }
-    missing_number = total_sum - actual_sum;
+}
 
-    printf("\nThe missing number from %d netural number is = %d .", size, missing_number);
+// Next chunk of the stream
+void gap_finder_add(struct gap_finder *f, const unsigned long long ids[], size_t n)
+{
+    mark(f, ids, n, 0);
+}
+
+struct mark_job
+{
+    struct gap_finder *f;
+    const unsigned long long *ids;
+    size_t n;
+};
 
+static void *mark_worker(void *arg)
+{
+    struct mark_job *job = (struct mark_job *)arg;
+
+    mark(job->f, job->ids, job->n, 1);
+    return NULL;
+}
+
+// Same as gap_finder_add(), the IDs split between up to `threads` threads
+void gap_finder_add_parallel(struct gap_finder *f, const unsigned long long ids[], size_t n, int threads)
+{
+    struct mark_job jobs[MAX_THREADS];
+    pthread_t tid[MAX_THREADS];
+    int started[MAX_THREADS];
+    size_t chunk;
+    int t;
+
+    if (threads > MAX_THREADS)
+    {
+        threads = MAX_THREADS;
+    }
+    if ((size_t)threads > n / MIN_CHUNK)
+    {
+        threads = (int)(n / MIN_CHUNK);
+    }
+    if (threads <= 1)
+    {
+        mark(f, ids, n, 0);
+        return;
+    }
+
+    chunk = (n + threads - 1) / threads;
+    for (t = 0; t < threads; t++)
+    {
+        size_t begin = t * chunk;
+
+        jobs[t].f = f;
+        jobs[t].ids = ids + begin;
+        jobs[t].n = (begin + chunk < n) ? chunk : n - begin;
+        started[t] = (pthread_create(&tid[t], NULL, mark_worker, &jobs[t]) == 0);
+        if (!started[t])
+        {
+            mark_worker(&jobs[t]);
+        }
+    }
+    for (t = 0; t < threads; t++)
+    {
+        if (started[t])
+        {
+            pthread_join(tid[t], NULL);
+        }
+    }
+}
+
+// IDs of a file of native 64-bit values, read through mmap.
+// Returns -1 when the file cannot be opened or mapped.
+int gap_finder_add_file(struct gap_finder *f, const char *path, int threads)
+{
+    struct stat st;
+    void *map;
+    int fd = open(path, O_RDONLY);
+
+    if (fd < 0)
+    {
+        return -1;
+    }
+    if (fstat(fd, &st) != 0)
+    {
+        close(fd);
+        return -1;
+    }
+    if (st.st_size < (off_t)sizeof(unsigned long long))
+    {
+        close(fd);
+        return 0;
+    }
+
+    map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+    {
+        return -1;
+    }
+    madvise(map, (size_t)st.st_size, MADV_SEQUENTIAL);
+    gap_finder_add_parallel(f, (const unsigned long long *)map,
+                            (size_t)st.st_size / sizeof(unsigned long long), threads);
+    munmap(map, (size_t)st.st_size);
     return 0;
-    
-}
\ No newline at end of file
+}
+
+// The gaps, in order. Writes at most max_out of them and returns how many
+// there are in total.
+size_t gap_finder_gaps(const struct gap_finder *f, struct gap out[], size_t max_out)
+{
+    unsigned long long open_at = 0;
+    unsigned long long last_bits = (f->hi - f->lo) % 64 + 1;
+    size_t w, count = 0;
+
+    for (w = 0; w < f->words; w++)
+    {
+        // Bits past hi count as seen
+        unsigned long long valid = (w + 1 < f->words || last_bits == 64) ? ~0ULL : (1ULL << last_bits) - 1;
+        unsigned long long missing = ~f->bits[w] & valid;
+        unsigned long long before, after, starts, ends, base;
+
+        if (missing == 0)
+        {
+            continue;
+        }
+
+        // A zero run starts where the bit below is set, ends where the bit above is
+        before = (w > 0 && (~f->bits[w - 1] >> 63)) ? 1 : 0;
+        after = (w + 1 < f->words && (~f->bits[w + 1] & 1)) ? 1 : 0;
+        base = f->lo + (unsigned long long)w * 64;
+        starts = missing & ~((missing << 1) | before);
+        ends = missing & ~((missing >> 1) | (after << 63));
+
+        while (starts != 0 || ends != 0)
+        {
+            if (starts != 0 && (ends == 0 || __builtin_ctzll(starts) <= __builtin_ctzll(ends)))
+            {
+                open_at = base + __builtin_ctzll(starts);
+                starts &= starts - 1;
+            }
+            else
+            {
+                if (count < max_out)
+                {
+                    out[count].first = open_at;
+                    out[count].last = base + __builtin_ctzll(ends);
+                }
+                count++;
+                ends &= ends - 1;
+            }
+        }
+    }
+    return count;
+}
+
+// ------------------------------------------------------------------
+// Fast path : one or two missing values
+// ------------------------------------------------------------------
+
+// XOR of 0 .. v
+static unsigned long long xor_upto(unsigned long long v)
+{
+    switch (v % 4)
+    {
+    case 0:
+        return v;
+    case 1:
+        return 1;
+    case 2:
+        return v + 1;
+    default:
+        return 0;
+    }
+}
+
+// lo + (lo + 1) + ... + hi, mod 2^64
+static unsigned long long sum_range(unsigned long long lo, unsigned long long hi)
+{
+    unsigned long long count = hi - lo + 1, a = lo + hi;
+
+    // One of count, lo + hi is even
+    return (count % 2 == 0) ? (count / 2) * a : count * (a / 2);
+}
+
+// For distinct IDs of [lo, hi] with 1 or 2 values missing : writes them to
+// missing[] and returns how many. Returns -1 when the input does not fit
+// that shape (other count, ID out of range, checks failing).
+int find_missing_few(const unsigned long long ids[], size_t n, unsigned long long lo,
+                     unsigned long long hi, unsigned long long missing[2])
+{
+    unsigned long long span = hi - lo, sum = 0, x = 0, pair, mid, below = 0, a;
+    size_t i;
+    int m;
+
+    if (lo > hi || n > span || span - n > 1)
+    {
+        return -1;
+    }
+    m = (int)(span + 1 - n);
+
+    for (i = 0; i < n; i++)
+    {
+        if (ids[i] - lo > span)
+        {
+            return -1;
+        }
+        sum += ids[i];
+        x ^= ids[i];
+    }
+    x ^= xor_upto(hi) ^ (lo > 0 ? xor_upto(lo - 1) : 0);
+    pair = sum_range(lo, hi) - sum;
+
+    if (m == 1)
+    {
+        if (x != pair)
+        {
+            return -1;
+        }
+        missing[0] = x;
+        return 1;
+    }
+
+    // a < b, so a <= (a + b) / 2 < b. The IDs <= mid sum to all of
+    // lo .. mid except a.
+    mid = lo + (pair - 2 * lo) / 2;
+    for (i = 0; i < n; i++)
+    {
+        below += (ids[i] <= mid) ? ids[i] : 0;
+    }
+    a = sum_range(lo, mid) - below;
+    if (a < lo || a > mid || pair - a <= mid || pair - a > hi || (a ^ (pair - a)) != x)
+    {
+        return -1;
+    }
+    missing[0] = a;
+    missing[1] = pair - a;
+    return 2;
+}
+
+// Gaps of [lo, hi] not covered by ids[0 .. n). Writes at most max_out gaps
+// and returns how many there are in total, or (size_t)-1 when memory runs out.
+// `distinct` enables the fast path : a duplicate ID can fool its checks.
+size_t find_gaps(const unsigned long long ids[], size_t n, unsigned long long lo, unsigned long long hi,
+                 struct gap out[], size_t max_out, int distinct, int threads)
+{
+    unsigned long long missing[2];
+    struct gap_finder *f;
+    size_t count;
+    int m, i;
+
+    m = distinct ? find_missing_few(ids, n, lo, hi, missing) : -1;
+    if (m > 0)
+    {
+        // Two neighbours make one gap
+        if (m == 2 && missing[1] == missing[0] + 1)
+        {
+            if (max_out > 0)
+            {
+                out[0].first = missing[0];
+                out[0].last = missing[1];
+            }
+            return 1;
+        }
+        for (i = 0; i < m && (size_t)i < max_out; i++)
+        {
+            out[i].first = out[i].last = missing[i];
+        }
+        return (size_t)m;
+    }
+
+    f = gap_finder_create(lo, hi);
+    if (f == NULL)
+    {
+        return (size_t)-1;
+    }
+    gap_finder_add_parallel(f, ids, n, threads);
+    count = gap_finder_gaps(f, out, max_out);
+    gap_finder_free(f);
+    return count;
+}
+
+// ------------------------------------------------------------------
+// Benchmark
+// ------------------------------------------------------------------
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static unsigned long long rng_state = 88172645463325252ULL;
+
+static unsigned long long next_random(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return rng_state;
+}
+
+static void run_benchmark(int log_n)
+{
+    unsigned long long range = 1ULL << log_n, v, missing[2];
+    int threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    unsigned long long *ids = (unsigned long long *)malloc(range * sizeof(unsigned long long));
+    struct gap gaps[4];
+    size_t n = 0, total;
+    double t0, t_bitmap, t_few;
+
+    if (ids == NULL)
+    {
+        printf("Out of memory.\n");
+        return;
+    }
+
+    // About 1 value in 1000 starts a gap of 1 to 8 values
+    for (v = 1; v <= range; v++)
+    {
+        if (next_random() % 1000 == 0)
+        {
+            v += next_random() % 8;
+            continue;
+        }
+        ids[n++] = v;
+    }
+
+    t0 = now_seconds();
+    total = find_gaps(ids, n, 1, range, gaps, 4, 0, threads);
+    t_bitmap = now_seconds() - t0;
+
+    // Exactly one missing value for the fast path
+    for (v = 0; v < range - 1; v++)
+    {
+        ids[v] = (v < range / 3) ? v + 1 : v + 2;
+    }
+    t0 = now_seconds();
+    find_missing_few(ids, range - 1, 1, range, missing);
+    t_few = now_seconds() - t0;
+
+    printf("[1, %llu], %d thread(s)\n", range, threads);
+    printf("  bitmap        : %6.2f ns / ID, %zu gaps\n", t_bitmap / n * 1e9, total);
+    printf("  XOR / sum     : %6.2f ns / ID, missing %llu\n", t_few / (range - 1) * 1e9, missing[0]);
+
+    free(ids);
+}
+
+static void print_gaps(const struct gap gaps[], size_t count)
+{
+    size_t i;
+
+    for (i = 0; i < count; i++)
+    {
+        if (gaps[i].first == gaps[i].last)
+        {
+            printf("%llu ", gaps[i].first);
+        }
+        else
+        {
+            printf("%llu-%llu ", gaps[i].first, gaps[i].last);
+        }
+    }
+    printf("\n");
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned long long arr[] = {1, 2, 3, 4, 6, 7, 8};
+    unsigned long long ids[] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 13, 14, 16, 17, 18, 19, 26, 27, 28, 29, 30};
+    size_t size = sizeof(arr)/sizeof(arr[0]) + 1, count;
+    struct gap gaps[16];
+
+    if (argc > 1 && strcmp(argv[1], "bench") == 0)
+    {
+        run_benchmark(argc > 2 ? atoi(argv[2]) : 26);
+        return 0;
+    }
+    if (argc > 4 && strcmp(argv[1], "file") == 0)
+    {
+        struct gap_finder *f = gap_finder_create(strtoull(argv[3], NULL, 10), strtoull(argv[4], NULL, 10));
+
+        if (f == NULL || gap_finder_add_file(f, argv[2], (int)sysconf(_SC_NPROCESSORS_ONLN)) != 0)
+        {
+            printf("Cannot read %s.\n", argv[2]);
+            gap_finder_free(f);
+            return 1;
+        }
+        count = gap_finder_gaps(f, gaps, 16);
+        printf("%zu gap(s) : ", count);
+        print_gaps(gaps, count < 16 ? count : 16);
+        gap_finder_free(f);
+        return 0;
+    }
+
+    find_gaps(arr, size - 1, 1, size, gaps, 16, 1, 1);
+    printf("\nThe missing number from %zu netural number is = %llu .", size, gaps[0].first);
+
+    count = find_gaps(ids, sizeof(ids) / sizeof(ids[0]), 1, 32, gaps, 16, 1, 1);
+    printf("\nThe gaps of 1 to 32 are : ");
+    print_gaps(gaps, count);
+
+    return 0;
+
+}
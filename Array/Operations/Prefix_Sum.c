@@ -0,0 +1,650 @@
+// Prefix sums (scan) of int, long long and float arrays.
+
+// Input : arr[] = {3, 1, 4, 1, 5, 9, 2, 6}
+// Output : inclusive 3 4 8 9 14 23 25 31
+//          exclusive 0 3 4 8 9 14 23 25
+
+// inclusive : out[i] = in[0] + ... + in[i]
+// exclusive : out[i] = in[0] + ... + in[i - 1], out[0] = 0
+// segmented : inclusive, but the sum restarts at every i with starts[i] != 0
+//  - In-register scan : 8 ints / floats or 4 long longs per AVX2 register.
+//    Adding the register to itself shifted by 1 and 2 lanes scans each
+//    128-bit half, the last lane of the low half is then added to the high
+//    half, and the running total of the previous registers to all lanes.
+//  - Threads, reduce then scan : pass 1 sums every thread's chunk, the chunk
+//    totals are scanned serially (one per thread), pass 2 scans every chunk
+//    starting from its total. The array is read twice, so it takes a few
+//    cores to beat the single pass when it does not fit in cache.
+//  - Segmented, threaded : pass 1 also records whether a chunk holds a start ;
+//    such a chunk passes on only its sum after its last start.
+// int sums wrap around like the SIMD adds (use long long for big sums). The
+// float kernels add in a different order than a plain loop, the results can
+// differ in the last bits.
+// range_sums_build() gives O(1) range sums of an int array after one pass,
+// e.g. for sliding windows or missing-value sums.
+
+// Time Complexity : O(n / threads + threads)
+// Space Complexity : O(threads), out may be the same array as in
+
+// Compile : gcc -O2 -pthread Prefix_Sum.c -o prefix_sum
+// Run     : ./prefix_sum              (small example)
+//           ./prefix_sum bench [logn] (loop, SIMD and threaded, GB/s)
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<time.h>
+#include<pthread.h>
+#include<unistd.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HAVE_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+#define MAX_THREADS 64
+
+// Smallest chunk worth a thread
+#define MIN_CHUNK (1 << 16)
+
+// ------------------------------------------------------------------
+// Scalar kernels, one set per element type
+// ------------------------------------------------------------------
+
+// The element types are handled through void pointers by the threaded
+// driver. `acc` is the type the sums are kept in : unsigned for the integers,
+// so that overflow wraps instead of being undefined.
+#define SCALAR_KERNELS(name, type, acc)                                                         \
+static void reduce_##name(const void *in_, size_t n, void *total)                               \
+{                                                                                               \
+    const type *in = (const type *)in_;                                                         \
+    acc sum = 0;                                                                                \
+    size_t i;                                                                                   \
+                                                                                                \
+    for (i = 0; i < n; i++)                                                                     \
+    {                                                                                           \
+        sum += (acc)in[i];                                                                      \
+    }                                                                                           \
+    *(type *)total = (type)sum;                                                                 \
+}                                                                                               \
+                                                                                                \
+static void scan_##name##_scalar(const void *in_, void *out_, size_t n, const void *carry,      \
+                                 int exclusive)                                                 \
+{                                                                                               \
+    const type *in = (const type *)in_;                                                         \
+    type *out = (type *)out_;                                                                   \
+    acc sum = (acc)*(const type *)carry;                                                        \
+    size_t i;                                                                                   \
+                                                                                                \
+    for (i = 0; i < n; i++)                                                                     \
+    {                                                                                           \
+        acc x = (acc)in[i];                                                                     \
+                                                                                                \
+        if (exclusive)                                                                          \
+        {                                                                                       \
+            out[i] = (type)sum;                                                                 \
+        }                                                                                       \
+        sum += x;                                                                               \
+        if (!exclusive)                                                                         \
+        {                                                                                       \
+            out[i] = (type)sum;                                                                 \
+        }                                                                                       \
+    }                                                                                           \
+}                                                                                               \
+                                                                                                \
+/* Sum after the last start of in[0 .. n), returns 1 when there is a start */                  \
+static int segment_reduce_##name(const void *in_, const unsigned char starts[], size_t n,       \
+                                 void *total)                                                   \
+{                                                                                               \
+    const type *in = (const type *)in_;                                                         \
+    acc sum = 0;                                                                                \
+    int found = 0;                                                                              \
+    size_t i;                                                                                   \
+                                                                                                \
+    for (i = 0; i < n; i++)                                                                     \
+    {                                                                                           \
+        found |= (starts[i] != 0);                                                              \
+        sum = (starts[i] ? 0 : sum) + (acc)in[i];                                               \
+    }                                                                                           \
+    *(type *)total = (type)sum;                                                                 \
+    return found;                                                                               \
+}                                                                                               \
+                                                                                                \
+static void segment_scan_##name(const void *in_, const unsigned char starts[], void *out_,      \
+                                size_t n, const void *carry)                                    \
+{                                                                                               \
+    const type *in = (const type *)in_;                                                         \
+    type *out = (type *)out_;                                                                   \
+    acc sum = (acc)*(const type *)carry;                                                        \
+    size_t i;                                                                                   \
+                                                                                                \
+    for (i = 0; i < n; i++)                                                                     \
+    {                                                                                           \
+        sum = (starts[i] ? 0 : sum) + (acc)in[i];                                               \
+        out[i] = (type)sum;                                                                     \
+    }                                                                                           \
+}                                                                                               \
+                                                                                                \
+static void add_##name(const void *a, const void *b, void *sum)                                 \
+{                                                                                               \
+    *(type *)sum = (type)((acc)*(const type *)a + (acc)*(const type *)b);                       \
+}
+
+SCALAR_KERNELS(int, int, unsigned int)
+SCALAR_KERNELS(long, long long, unsigned long long)
+SCALAR_KERNELS(float, float, float)
+
+// ------------------------------------------------------------------
+// In-register SIMD scans
+// ------------------------------------------------------------------
+
+#ifdef HAVE_X86_SIMD
+
+__attribute__((target("avx2")))
+static void scan_int_avx2(const void *in_, void *out_, size_t n, const void *carry_, int exclusive)
+{
+    const int *in = (const int *)in_;
+    int *out = (int *)out_;
+    __m256i carry = _mm256_set1_epi32(*(const int *)carry_);
+    const __m256i last = _mm256_set1_epi32(7), previous = _mm256_setr_epi32(7, 0, 1, 2, 3, 4, 5, 6);
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256i x = _mm256_loadu_si256((const __m256i *)(in + i));
+        __m256i low_total;
+
+        x = _mm256_add_epi32(x, _mm256_slli_si256(x, 4));
+        x = _mm256_add_epi32(x, _mm256_slli_si256(x, 8));
+        // Lane 3 of the low half into every lane of the high half
+        low_total = _mm256_shuffle_epi32(x, _MM_SHUFFLE(3, 3, 3, 3));
+        x = _mm256_add_epi32(x, _mm256_permute2x128_si256(low_total, low_total, 0x08));
+
+        if (exclusive)
+        {
+            // One lane to the right, 0 in lane 0
+            __m256i shifted = _mm256_blend_epi32(_mm256_permutevar8x32_epi32(x, previous), _mm256_setzero_si256(), 0x01);
+
+            _mm256_storeu_si256((__m256i *)(out + i), _mm256_add_epi32(shifted, carry));
+        }
+        else
+        {
+            _mm256_storeu_si256((__m256i *)(out + i), _mm256_add_epi32(x, carry));
+        }
+        carry = _mm256_add_epi32(carry, _mm256_permutevar8x32_epi32(x, last));
+    }
+
+    {
+        int rest = _mm256_cvtsi256_si32(carry);
+
+        scan_int_scalar(in + i, out + i, n - i, &rest, exclusive);
+    }
+}
+
+__attribute__((target("avx2")))
+static void scan_long_avx2(const void *in_, void *out_, size_t n, const void *carry_, int exclusive)
+{
+    const long long *in = (const long long *)in_;
+    long long *out = (long long *)out_;
+    __m256i carry = _mm256_set1_epi64x(*(const long long *)carry_);
+    size_t i = 0;
+
+    for (; i + 4 <= n; i += 4)
+    {
+        __m256i x = _mm256_loadu_si256((const __m256i *)(in + i));
+
+        x = _mm256_add_epi64(x, _mm256_slli_si256(x, 8));
+        // Lane 1 into lanes 2 and 3
+        x = _mm256_add_epi64(x, _mm256_blend_epi32(_mm256_setzero_si256(),
+                                                   _mm256_permute4x64_epi64(x, _MM_SHUFFLE(1, 1, 1, 1)), 0xF0));
+
+        if (exclusive)
+        {
+            __m256i shifted = _mm256_blend_epi32(_mm256_permute4x64_epi64(x, _MM_SHUFFLE(2, 1, 0, 3)),
+                                                 _mm256_setzero_si256(), 0x03);
+
+            _mm256_storeu_si256((__m256i *)(out + i), _mm256_add_epi64(shifted, carry));
+        }
+        else
+        {
+            _mm256_storeu_si256((__m256i *)(out + i), _mm256_add_epi64(x, carry));
+        }
+        carry = _mm256_add_epi64(carry, _mm256_permute4x64_epi64(x, _MM_SHUFFLE(3, 3, 3, 3)));
+    }
+
+    {
+        long long rest = _mm256_extract_epi64(carry, 0);
+
+        scan_long_scalar(in + i, out + i, n - i, &rest, exclusive);
+    }
+}
+
+__attribute__((target("avx2")))
+static void scan_float_avx2(const void *in_, void *out_, size_t n, const void *carry_, int exclusive)
+{
+    const float *in = (const float *)in_;
+    float *out = (float *)out_;
+    __m256 carry = _mm256_set1_ps(*(const float *)carry_);
+    const __m256i last = _mm256_set1_epi32(7), previous = _mm256_setr_epi32(7, 0, 1, 2, 3, 4, 5, 6);
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256 x = _mm256_loadu_ps(in + i), low_total;
+
+        x = _mm256_add_ps(x, _mm256_castsi256_ps(_mm256_slli_si256(_mm256_castps_si256(x), 4)));
+        x = _mm256_add_ps(x, _mm256_castsi256_ps(_mm256_slli_si256(_mm256_castps_si256(x), 8)));
+        low_total = _mm256_shuffle_ps(x, x, _MM_SHUFFLE(3, 3, 3, 3));
+        x = _mm256_add_ps(x, _mm256_permute2f128_ps(low_total, low_total, 0x08));
+
+        if (exclusive)
+        {
+            __m256 shifted = _mm256_blend_ps(_mm256_permutevar8x32_ps(x, previous), _mm256_setzero_ps(), 0x01);
+
+            _mm256_storeu_ps(out + i, _mm256_add_ps(shifted, carry));
+        }
+        else
+        {
+            _mm256_storeu_ps(out + i, _mm256_add_ps(x, carry));
+        }
+        carry = _mm256_add_ps(carry, _mm256_permutevar8x32_ps(x, last));
+    }
+
+    {
+        float rest = _mm256_cvtss_f32(carry);
+
+        scan_float_scalar(in + i, out + i, n - i, &rest, exclusive);
+    }
+}
+
+#endif
+
+// ------------------------------------------------------------------
+// Threaded driver
+// ------------------------------------------------------------------
+
+typedef void (*scan_kernel)(const void *, void *, size_t, const void *, int);
+
+// A total or carry of any of the element types, all zero bits is 0
+union scan_value
+{
+    int i;
+    long long l;
+    float f;
+};
+
+struct scan_ops
+{
+    size_t size;
+    void (*reduce)(const void *, size_t, void *);
+    scan_kernel scan;
+    int (*segment_reduce)(const void *, const unsigned char *, size_t, void *);
+    void (*segment_scan)(const void *, const unsigned char *, void *, size_t, const void *);
+    void (*add)(const void *, const void *, void *);
+};
+
+static struct scan_ops int_ops = {sizeof(int), reduce_int, scan_int_scalar,
+                                  segment_reduce_int, segment_scan_int, add_int};
+static struct scan_ops long_ops = {sizeof(long long), reduce_long, scan_long_scalar,
+                                   segment_reduce_long, segment_scan_long, add_long};
+static struct scan_ops float_ops = {sizeof(float), reduce_float, scan_float_scalar,
+                                    segment_reduce_float, segment_scan_float, add_float};
+
+// Picks the SIMD scans once
+static void init_ops(void)
+{
+    static int done = 0;
+
+    if (!done)
+    {
+#ifdef HAVE_X86_SIMD
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2"))
+        {
+            int_ops.scan = scan_int_avx2;
+            long_ops.scan = scan_long_avx2;
+            float_ops.scan = scan_float_avx2;
+        }
+#endif
+        done = 1;
+    }
+}
+
+struct scan_job
+{
+    const struct scan_ops *ops;
+    const unsigned char *in;
+    unsigned char *out;
+    const unsigned char *starts;    // NULL unless segmented
+    size_t n;
+    int exclusive, pass;
+    int has_start;
+    union scan_value total;         // pass 1 : sum of the chunk ; pass 2 : carry in
+};
+
+static void *scan_worker(void *arg)
+{
+    struct scan_job *job = (struct scan_job *)arg;
+    const struct scan_ops *ops = job->ops;
+
+    if (job->pass == 1)
+    {
+        if (job->starts != NULL)
+        {
+            job->has_start = ops->segment_reduce(job->in, job->starts, job->n, &job->total);
+        }
+        else
+        {
+            ops->reduce(job->in, job->n, &job->total);
+        }
+    }
+    else if (job->starts != NULL)
+    {
+        ops->segment_scan(job->in, job->starts, job->out, job->n, &job->total);
+    }
+    else
+    {
+        ops->scan(job->in, job->out, job->n, &job->total, job->exclusive);
+    }
+    return NULL;
+}
+
+static void run_pass(struct scan_job jobs[], int threads, int pass)
+{
+    pthread_t tid[MAX_THREADS];
+    int started[MAX_THREADS];
+    int t;
+
+    for (t = 1; t < threads; t++)
+    {
+        jobs[t].pass = pass;
+        started[t] = (pthread_create(&tid[t], NULL, scan_worker, &jobs[t]) == 0);
+        if (!started[t])
+        {
+            scan_worker(&jobs[t]);
+        }
+    }
+    jobs[0].pass = pass;
+    scan_worker(&jobs[0]);
+    for (t = 1; t < threads; t++)
+    {
+        if (started[t])
+        {
+            pthread_join(tid[t], NULL);
+        }
+    }
+}
+
+static void scan_any(const struct scan_ops *ops, const void *in, void *out, const unsigned char starts[],
+                     size_t n, int exclusive, int threads)
+{
+    struct scan_job jobs[MAX_THREADS];
+    union scan_value zero, carry;
+    size_t chunk;
+    int t;
+
+    init_ops();
+    memset(&zero, 0, sizeof(zero));
+    carry = zero;
+    if (threads > MAX_THREADS)
+    {
+        threads = MAX_THREADS;
+    }
+    if ((size_t)threads > n / MIN_CHUNK)
+    {
+        threads = (int)(n / MIN_CHUNK);
+    }
+    if (threads <= 1)
+    {
+        if (starts != NULL)
+        {
+            ops->segment_scan(in, starts, out, n, &zero);
+        }
+        else
+        {
+            ops->scan(in, out, n, &zero, exclusive);
+        }
+        return;
+    }
+
+    // Chunks of whole cache lines
+    chunk = ((n + threads - 1) / threads + 15) & ~(size_t)15;
+    for (t = 0; t < threads; t++)
+    {
+        size_t begin = (t * chunk < n) ? t * chunk : n;
+
+        jobs[t].ops = ops;
+        jobs[t].in = (const unsigned char *)in + begin * ops->size;
+        jobs[t].out = (unsigned char *)out + begin * ops->size;
+        jobs[t].starts = (starts != NULL) ? starts + begin : NULL;
+        jobs[t].n = (begin + chunk < n) ? chunk : n - begin;
+        jobs[t].exclusive = exclusive;
+        jobs[t].has_start = 0;
+        jobs[t].total = zero;
+    }
+
+    run_pass(jobs, threads, 1);
+
+    // Carry into every chunk : the scan of the totals before it
+    for (t = 0; t < threads; t++)
+    {
+        union scan_value total = jobs[t].total;
+
+        jobs[t].total = carry;
+        if (jobs[t].has_start)
+        {
+            carry = total;
+        }
+        else
+        {
+            ops->add(&carry, &total, &carry);
+        }
+    }
+
+    run_pass(jobs, threads, 2);
+}
+
+// ------------------------------------------------------------------
+// Public functions
+// ------------------------------------------------------------------
+
+// Prefix sums of in[0 .. n) into out[] (inclusive, or exclusive when
+// exclusive != 0) on up to `threads` threads
+void prefix_sum_int(const int in[], int out[], size_t n, int exclusive, int threads)
+{
+    scan_any(&int_ops, in, out, NULL, n, exclusive, threads);
+}
+
+void prefix_sum_long(const long long in[], long long out[], size_t n, int exclusive, int threads)
+{
+    scan_any(&long_ops, in, out, NULL, n, exclusive, threads);
+}
+
+void prefix_sum_float(const float in[], float out[], size_t n, int exclusive, int threads)
+{
+    scan_any(&float_ops, in, out, NULL, n, exclusive, threads);
+}
+
+// Inclusive sums restarting at every i with starts[i] != 0
+void segmented_sum_int(const int in[], const unsigned char starts[], int out[], size_t n, int threads)
+{
+    scan_any(&int_ops, in, out, starts, n, 0, threads);
+}
+
+void segmented_sum_long(const long long in[], const unsigned char starts[], long long out[], size_t n, int threads)
+{
+    scan_any(&long_ops, in, out, starts, n, 0, threads);
+}
+
+void segmented_sum_float(const float in[], const unsigned char starts[], float out[], size_t n, int threads)
+{
+    scan_any(&float_ops, in, out, starts, n, 0, threads);
+}
+
+// ------------------------------------------------------------------
+// O(1) range sums
+// ------------------------------------------------------------------
+
+// prefix[i] = arr[0] + ... + arr[i - 1], n + 1 entries
+struct range_sums
+{
+    long long *prefix;
+    size_t n;
+};
+
+// Returns 0, or -1 when memory runs out
+int range_sums_build(struct range_sums *rs, const int arr[], size_t n, int threads)
+{
+    size_t i;
+
+    rs->n = n;
+    rs->prefix = (long long *)malloc((n + 1) * sizeof(long long));
+    if (rs->prefix == NULL)
+    {
+        return -1;
+    }
+    for (i = 0; i < n; i++)
+    {
+        rs->prefix[i] = arr[i];
+    }
+    rs->prefix[n] = 0;
+    prefix_sum_long(rs->prefix, rs->prefix, n + 1, 1, threads);
+    return 0;
+}
+
+void range_sums_free(struct range_sums *rs)
+{
+    free(rs->prefix);
+    rs->prefix = NULL;
+}
+
+// arr[begin] + ... + arr[end - 1]
+long long range_sum(const struct range_sums *rs, size_t begin, size_t end)
+{
+    return rs->prefix[end] - rs->prefix[begin];
+}
+
+// ------------------------------------------------------------------
+// Benchmark
+// ------------------------------------------------------------------
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static unsigned long long rng_state = 88172645463325252ULL;
+
+static unsigned long long next_random(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return rng_state;
+}
+
+static void run_benchmark(int log_n)
+{
+    size_t n = (size_t)1 << log_n, i;
+    int threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    int *in = (int *)malloc(n * sizeof(int)), *out = (int *)malloc(n * sizeof(int));
+    unsigned char *starts = (unsigned char *)malloc(n);
+    double t0, t_loop, t_simd, t_threads, t_segmented;
+    unsigned int sum = 0;
+    int zero = 0;
+
+    if (in == NULL || out == NULL || starts == NULL)
+    {
+        printf("Out of memory.\n");
+        free(in);
+        free(out);
+        free(starts);
+        return;
+    }
+    for (i = 0; i < n; i++)
+    {
+        in[i] = (int)(next_random() % 201) - 100;
+        starts[i] = (next_random() % 1000 == 0);
+    }
+    memset(out, 0, n * sizeof(int));
+
+    t0 = now_seconds();
+    for (i = 0; i < n; i++)
+    {
+        sum += (unsigned int)in[i];
+        out[i] = (int)sum;
+    }
+    t_loop = now_seconds() - t0;
+
+    init_ops();
+    t0 = now_seconds();
+    int_ops.scan(in, out, n, &zero, 0);
+    t_simd = now_seconds() - t0;
+
+    t0 = now_seconds();
+    prefix_sum_int(in, out, n, 0, threads);
+    t_threads = now_seconds() - t0;
+
+    t0 = now_seconds();
+    segmented_sum_int(in, starts, out, n, threads);
+    t_segmented = now_seconds() - t0;
+
+    // Read and write : 8 bytes per element
+    printf("n = %zu ints, %d thread(s)\n", n, threads);
+    printf("  plain loop      : %6.2f GB/s\n", n * 8.0 / t_loop * 1e-9);
+    printf("  in-register     : %6.2f GB/s\n", n * 8.0 / t_simd * 1e-9);
+    printf("  threaded        : %6.2f GB/s\n", n * 8.0 / t_threads * 1e-9);
+    printf("  segmented       : %6.2f GB/s\n", n * 9.0 / t_segmented * 1e-9);
+
+    free(in);
+    free(out);
+    free(starts);
+}
+
+int main(int argc, char *argv[])
+{
+    int arr[] = {3, 1, 4, 1, 5, 9, 2, 6}, out[8];
+    unsigned char starts[] = {1, 0, 0, 1, 0, 0, 1, 0};
+    size_t i, n = sizeof(arr) / sizeof(arr[0]);
+    struct range_sums rs;
+
+    if (argc > 1 && strcmp(argv[1], "bench") == 0)
+    {
+        run_benchmark(argc > 2 ? atoi(argv[2]) : 26);
+        return 0;
+    }
+
+    prefix_sum_int(arr, out, n, 0, 1);
+    printf("\nInclusive : ");
+    for (i = 0; i < n; i++)
+    {
+        printf("%d ", out[i]);
+    }
+
+    prefix_sum_int(arr, out, n, 1, 1);
+    printf("\nExclusive : ");
+    for (i = 0; i < n; i++)
+    {
+        printf("%d ", out[i]);
+    }
+
+    segmented_sum_int(arr, starts, out, n, 1);
+    printf("\nSegmented (starts at 0, 3, 6) : ");
+    for (i = 0; i < n; i++)
+    {
+        printf("%d ", out[i]);
+    }
+
+    if (range_sums_build(&rs, arr, n, 1) != 0)
+    {
+        printf("Out of memory.\n");
+        return 1;
+    }
+    printf("\nSum of arr[2 .. 6) = %lld\n", range_sum(&rs, 2, 6));
+    range_sums_free(&rs);
+
+    return 0;
+}
@@ -0,0 +1,609 @@
+// Range update and range query : segment tree with lazy propagation, and a
+// Fenwick (binary indexed) tree for sums only.
+
+// Update.c changes one element and Search.c scans, so a range sum / min / max
+// after range updates costs O(n). Here both are O(log n).
+
+// Segment tree : implicit heap layout in one array, node 1 is the root, the
+// children of node k are 2k and 2k + 1, the leaves are padded to a power of
+// two. A node keeps the sum, min and max of its range and a pending "add to
+// the whole range" (lazy) that is pushed to the children only when a later
+// operation goes below the node. One node is 32 bytes, two per cache line,
+// and the top levels that every operation touches stay in cache.
+//  - segtree_build()       : bottom-up from an array, O(n).
+//  - segtree_add()         : add delta to arr[l .. r), O(log n).
+//  - segtree_set()         : arr[i] = value, O(log n).
+//  - segtree_query()       : sum, min and max of arr[l .. r), O(log n).
+//  - segtree_query_batch() : many queries, answered in order of position so
+//                            neighbouring queries share the cached paths.
+
+// Fenwick tree : range add and range sum with two prefix-sum trees,
+// sum(0 .. i) = B1(i) * i - B2(i). Half the memory, and faster for sums.
+
+// Compile : gcc -O2 Segment_Tree.c -o segment_tree
+// Run     : ./segment_tree              (small example)
+//           ./segment_tree bench [logn] (random updates and queries)
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<limits.h>
+#include<time.h>
+
+struct seg_node
+{
+    long long sum, min, max;
+    long long lazy;             // added to every element, not yet to the children
+};
+
+struct segment_tree
+{
+    struct seg_node *node;      // node[1 .. 2 * leaves)
+    size_t n, leaves;
+};
+
+struct range_result
+{
+    long long sum, min, max;
+};
+
+struct range_query
+{
+    size_t l, r;                // [l, r)
+};
+
+// ------------------------------------------------------------------
+// Segment tree
+// ------------------------------------------------------------------
+
+static void pull(struct seg_node *node, size_t k)
+{
+    const struct seg_node *a = &node[2 * k], *b = &node[2 * k + 1];
+
+    node[k].sum = a->sum + b->sum;
+    node[k].min = (a->min < b->min) ? a->min : b->min;
+    node[k].max = (a->max > b->max) ? a->max : b->max;
+}
+
+static void apply(struct seg_node *node, size_t k, size_t length, long long delta)
+{
+    node[k].sum += delta * (long long)length;
+    node[k].min += delta;
+    node[k].max += delta;
+    node[k].lazy += delta;
+}
+
+static void push(struct seg_node *node, size_t k, size_t length)
+{
+    if (node[k].lazy != 0)
+    {
+        apply(node, 2 * k, length / 2, node[k].lazy);
+        apply(node, 2 * k + 1, length / 2, node[k].lazy);
+        node[k].lazy = 0;
+    }
+}
+
+void segtree_free(struct segment_tree *t)
+{
+    if (t != NULL)
+    {
+        free(t->node);
+        free(t);
+    }
+}
+
+// Tree over arr[0 .. n), n > 0. Returns NULL when memory runs out.
+struct segment_tree *segtree_build(const int arr[], size_t n)
+{
+    struct segment_tree *t = (struct segment_tree *)malloc(sizeof(struct segment_tree));
+    size_t k;
+
+    if (t == NULL || n == 0)
+    {
+        free(t);
+        return NULL;
+    }
+    t->n = n;
+    t->leaves = 1;
+    while (t->leaves < n)
+    {
+        t->leaves *= 2;
+    }
+    t->node = (struct seg_node *)malloc(2 * t->leaves * sizeof(struct seg_node));
+    if (t->node == NULL)
+    {
+        free(t);
+        return NULL;
+    }
+
+    // Padding leaves never win a min / max and add nothing to a sum. No update
+    // covers them fully, so they never get a lazy add either.
+    for (k = 0; k < t->leaves; k++)
+    {
+        struct seg_node *leaf = &t->node[t->leaves + k];
+
+        leaf->sum = (k < n) ? arr[k] : 0;
+        leaf->min = (k < n) ? arr[k] : LLONG_MAX;
+        leaf->max = (k < n) ? arr[k] : LLONG_MIN;
+        leaf->lazy = 0;
+    }
+    for (k = t->leaves - 1; k >= 1; k--)
+    {
+        pull(t->node, k);
+        t->node[k].lazy = 0;
+    }
+    return t;
+}
+
+// Node k covers [lo, lo + length)
+static void add_range(struct seg_node *node, size_t k, size_t lo, size_t length,
+                      size_t l, size_t r, long long delta)
+{
+    size_t half = length / 2;
+
+    if (l <= lo && lo + length <= r)
+    {
+        apply(node, k, length, delta);
+        return;
+    }
+
+    push(node, k, length);
+    if (l < lo + half)
+    {
+        add_range(node, 2 * k, lo, half, l, r, delta);
+    }
+    if (r > lo + half)
+    {
+        add_range(node, 2 * k + 1, lo + half, half, l, r, delta);
+    }
+    pull(node, k);
+}
+
+static void query_range(struct seg_node *node, size_t k, size_t lo, size_t length,
+                        size_t l, size_t r, struct range_result *res)
+{
+    size_t half = length / 2;
+
+    if (l <= lo && lo + length <= r)
+    {
+        res->sum += node[k].sum;
+        res->min = (node[k].min < res->min) ? node[k].min : res->min;
+        res->max = (node[k].max > res->max) ? node[k].max : res->max;
+        return;
+    }
+
+    push(node, k, length);
+    if (l < lo + half)
+    {
+        query_range(node, 2 * k, lo, half, l, r, res);
+    }
+    if (r > lo + half)
+    {
+        query_range(node, 2 * k + 1, lo + half, half, l, r, res);
+    }
+}
+
+// Adds delta to arr[l .. r). Returns -1 for an empty or out of range [l, r).
+int segtree_add(struct segment_tree *t, size_t l, size_t r, long long delta)
+{
+    if (l >= r || r > t->n)
+    {
+        return -1;
+    }
+    add_range(t->node, 1, 0, t->leaves, l, r, delta);
+    return 0;
+}
+
+// arr[i] = value. Returns -1 when i is out of range.
+int segtree_set(struct segment_tree *t, size_t i, long long value)
+{
+    size_t k = 1, lo = 0, length = t->leaves;
+
+    if (i >= t->n)
+    {
+        return -1;
+    }
+
+    // Down to the leaf, pushing the pending adds on the way
+    while (length > 1)
+    {
+        push(t->node, k, length);
+        length /= 2;
+        if (i < lo + length)
+        {
+            k = 2 * k;
+        }
+        else
+        {
+            k = 2 * k + 1;
+            lo += length;
+        }
+    }
+
+    t->node[k].sum = t->node[k].min = t->node[k].max = value;
+    for (k /= 2; k >= 1; k /= 2)
+    {
+        pull(t->node, k);
+    }
+    return 0;
+}
+
+// Sum, min and max of arr[l .. r). Returns -1 for an empty or out of range [l, r).
+int segtree_query(struct segment_tree *t, size_t l, size_t r, struct range_result *res)
+{
+    if (l >= r || r > t->n)
+    {
+        return -1;
+    }
+    res->sum = 0;
+    res->min = LLONG_MAX;
+    res->max = LLONG_MIN;
+    query_range(t->node, 1, 0, t->leaves, l, r, res);
+    return 0;
+}
+
+// Answers queries[0 .. m) into results[0 .. m), visiting them by position :
+// a counting sort on l puts them in about m buckets, so neighbouring queries
+// share the cached paths. An empty or out of range query gets sum 0,
+// min LLONG_MAX, max LLONG_MIN. Returns -1 when memory runs out (nothing is
+// answered).
+int segtree_query_batch(struct segment_tree *t, const struct range_query queries[], size_t m,
+                        struct range_result results[])
+{
+    size_t buckets = (m < t->n) ? m : t->n;
+    size_t *order = (size_t *)malloc(m * sizeof(size_t));
+    size_t *start = (size_t *)calloc(buckets + 1, sizeof(size_t));
+    size_t i;
+
+    if (m == 0)
+    {
+        free(order);
+        free(start);
+        return 0;
+    }
+    if (order == NULL || start == NULL)
+    {
+        free(order);
+        free(start);
+        return -1;
+    }
+
+    // Bucket of l is l * buckets / n (out of range l go to the last bucket)
+    for (i = 0; i < m; i++)
+    {
+        size_t l = (queries[i].l < t->n) ? queries[i].l : t->n - 1;
+
+        start[(unsigned long long)l * buckets / t->n + 1]++;
+    }
+    for (i = 1; i <= buckets; i++)
+    {
+        start[i] += start[i - 1];
+    }
+    for (i = 0; i < m; i++)
+    {
+        size_t l = (queries[i].l < t->n) ? queries[i].l : t->n - 1;
+
+        order[start[(unsigned long long)l * buckets / t->n]++] = i;
+    }
+
+    for (i = 0; i < m; i++)
+    {
+        const struct range_query *q = &queries[order[i]];
+        struct range_result *res = &results[order[i]];
+
+        if (segtree_query(t, q->l, q->r, res) != 0)
+        {
+            res->sum = 0;
+            res->min = LLONG_MAX;
+            res->max = LLONG_MIN;
+        }
+    }
+
+    free(order);
+    free(start);
+    return 0;
+}
+
+// ------------------------------------------------------------------
+// Fenwick tree : range add, range sum
+// ------------------------------------------------------------------
+
+struct fenwick
+{
+    long long *b1, *b2;         // 1-based
+    size_t n;
+};
+
+void fenwick_free(struct fenwick *f)
+{
+    if (f != NULL)
+    {
+        free(f->b1);
+        free(f->b2);
+        free(f);
+    }
+}
+
+// O(n) : every node hands its total to its parent i + (i & -i)
+struct fenwick *fenwick_build(const int arr[], size_t n)
+{
+    struct fenwick *f = (struct fenwick *)malloc(sizeof(struct fenwick));
+    size_t i;
+
+    if (f == NULL)
+    {
+        return NULL;
+    }
+    f->n = n;
+    f->b1 = (long long *)calloc(n + 1, sizeof(long long));
+    f->b2 = (long long *)calloc(n + 1, sizeof(long long));
+    if (f->b1 == NULL || f->b2 == NULL)
+    {
+        fenwick_free(f);
+        return NULL;
+    }
+
+    // With no range adds yet B1 is 0 and prefix(i) = -B2(i), so B2 holds -arr
+    for (i = 1; i <= n; i++)
+    {
+        size_t parent = i + (i & (~i + 1));
+
+        f->b2[i] -= arr[i - 1];
+        if (parent <= n)
+        {
+            f->b2[parent] += f->b2[i];
+        }
+    }
+    return f;
+}
+
+static void fenwick_update(long long *tree, size_t n, size_t i, long long delta)
+{
+    for (; i <= n; i += i & (~i + 1))
+    {
+        tree[i] += delta;
+    }
+}
+
+static long long fenwick_prefix_tree(const long long *tree, size_t i)
+{
+    long long sum = 0;
+
+    for (; i > 0; i -= i & (~i + 1))
+    {
+        sum += tree[i];
+    }
+    return sum;
+}
+
+// Sum of arr[0 .. i)
+static long long fenwick_prefix(const struct fenwick *f, size_t i)
+{
+    return fenwick_prefix_tree(f->b1, i) * (long long)i - fenwick_prefix_tree(f->b2, i);
+}
+
+// Adds delta to arr[l .. r). Returns -1 for an empty or out of range [l, r).
+int fenwick_add(struct fenwick *f, size_t l, size_t r, long long delta)
+{
+    if (l >= r || r > f->n)
+    {
+        return -1;
+    }
+    fenwick_update(f->b1, f->n, l + 1, delta);
+    fenwick_update(f->b1, f->n, r + 1, -delta);
+    fenwick_update(f->b2, f->n, l + 1, delta * (long long)l);
+    fenwick_update(f->b2, f->n, r + 1, -delta * (long long)r);
+    return 0;
+}
+
+// Sum of arr[l .. r), 0 for an empty or out of range [l, r)
+long long fenwick_sum(const struct fenwick *f, size_t l, size_t r)
+{
+    if (l >= r || r > f->n)
+    {
+        return 0;
+    }
+    return fenwick_prefix(f, r) - fenwick_prefix(f, l);
+}
+
+// ------------------------------------------------------------------
+// Benchmark
+// ------------------------------------------------------------------
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static unsigned long long rng_state = 88172645463325252ULL;
+
+static unsigned long long next_random(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return rng_state;
+}
+
+static void random_range(size_t n, size_t *l, size_t *r)
+{
+    size_t a = next_random() % n, b = next_random() % n;
+
+    *l = (a < b) ? a : b;
+    *r = ((a < b) ? b : a) + 1;
+}
+
+static void run_benchmark(int log_n)
+{
+    size_t n = (size_t)1 << log_n, ops = 1 << 20, naive_ops = 256, i, j;
+    int *arr = (int *)malloc(n * sizeof(int));
+    struct segment_tree *t;
+    struct fenwick *f;
+    struct range_query *queries = (struct range_query *)malloc(ops * sizeof(struct range_query));
+    struct range_result *results = (struct range_result *)malloc(ops * sizeof(struct range_result));
+    long long check[4] = {0, 0, 0, 0};
+    unsigned long long seed;
+    double t0, t_build, t_seg, t_fen, t_naive, t_single, t_batch;
+
+    if (arr == NULL || queries == NULL || results == NULL)
+    {
+        printf("Out of memory.\n");
+        free(arr);
+        free(queries);
+        free(results);
+        return;
+    }
+    for (i = 0; i < n; i++)
+    {
+        arr[i] = (int)(next_random() % 1000);
+    }
+
+    t0 = now_seconds();
+    t = segtree_build(arr, n);
+    t_build = now_seconds() - t0;
+    f = fenwick_build(arr, n);
+    if (t == NULL || f == NULL)
+    {
+        printf("Out of memory.\n");
+        segtree_free(t);
+        fenwick_free(f);
+        free(arr);
+        free(queries);
+        free(results);
+        return;
+    }
+
+    // Alternate a range add and a range query, the same ones for both trees
+    seed = rng_state;
+    t0 = now_seconds();
+    for (i = 0; i < ops; i++)
+    {
+        struct range_result res;
+        size_t l, r;
+
+        random_range(n, &l, &r);
+        segtree_add(t, l, r, (long long)(next_random() % 7) - 3);
+        random_range(n, &l, &r);
+        segtree_query(t, l, r, &res);
+        check[0] += res.sum;
+    }
+    t_seg = (now_seconds() - t0) / (2 * ops);
+
+    rng_state = seed;
+    t0 = now_seconds();
+    for (i = 0; i < ops; i++)
+    {
+        size_t l, r;
+
+        random_range(n, &l, &r);
+        fenwick_add(f, l, r, (long long)(next_random() % 7) - 3);
+        random_range(n, &l, &r);
+        check[1] += fenwick_sum(f, l, r);
+    }
+    t_fen = (now_seconds() - t0) / (2 * ops);
+
+    t0 = now_seconds();
+    for (i = 0; i < naive_ops; i++)
+    {
+        size_t l, r;
+        long long sum = 0;
+
+        random_range(n, &l, &r);
+        for (j = l; j < r; j++)
+        {
+            arr[j] += 1;
+        }
+        random_range(n, &l, &r);
+        for (j = l; j < r; j++)
+        {
+            sum += arr[j];
+        }
+        check[2] += sum;
+    }
+    t_naive = (now_seconds() - t0) / (2 * naive_ops);
+
+    // Same queries one by one, then as a batch
+    for (i = 0; i < ops; i++)
+    {
+        random_range(n, &queries[i].l, &queries[i].r);
+        queries[i].r = (queries[i].r - queries[i].l > 64) ? queries[i].l + 64 : queries[i].r;
+    }
+    t0 = now_seconds();
+    for (i = 0; i < ops; i++)
+    {
+        segtree_query(t, queries[i].l, queries[i].r, &results[i]);
+        check[3] += results[i].max;
+    }
+    t_single = (now_seconds() - t0) / ops;
+    t0 = now_seconds();
+    segtree_query_batch(t, queries, ops, results);
+    t_batch = (now_seconds() - t0) / ops;
+    for (i = 0; i < ops; i++)
+    {
+        check[3] -= results[i].max;
+    }
+
+    printf("n = %zu\n", n);
+    printf("  segment tree build       : %8.1f ms\n", t_build * 1e3);
+    printf("  segment tree add / query : %8.1f ns\n", t_seg * 1e9);
+    printf("  Fenwick add / sum        : %8.1f ns (sums %s)\n", t_fen * 1e9, check[0] == check[1] ? "match" : "DIFFER");
+    printf("  loop add / sum           : %8.1f ns\n", t_naive * 1e9);
+    printf("  short queries one by one : %8.1f ns\n", t_single * 1e9);
+    printf("  short queries batched    : %8.1f ns (difference %lld)\n", t_batch * 1e9, check[3]);
+
+    segtree_free(t);
+    fenwick_free(f);
+    free(arr);
+    free(queries);
+    free(results);
+}
+
+int main(int argc, char *argv[])
+{
+    int arr[20] = {1, 2, 3, 4, 5}; // First 5 elements are initialized, rest are 0.
+    int i, updateNum = 32, pos = 3, n = 5;
+    struct segment_tree *t;
+    struct fenwick *f;
+    struct range_result res;
+
+    if (argc > 1 && strcmp(argv[1], "bench") == 0)
+    {
+        run_benchmark(argc > 2 ? atoi(argv[2]) : 22);
+        return 0;
+    }
+
+    t = segtree_build(arr, n);
+    f = fenwick_build(arr, n);
+    if (t == NULL || f == NULL)
+    {
+        printf("Out of memory.\n");
+        segtree_free(t);
+        fenwick_free(f);
+        return 1;
+    }
+
+    // Updating the element at position 3 (index 2)
+    segtree_set(t, pos - 1, updateNum);
+    fenwick_add(f, pos - 1, pos, updateNum - arr[pos - 1]);
+
+    // Adding 10 to positions 2 to 4 (index 1 to 3)
+    segtree_add(t, 1, 4, 10);
+    fenwick_add(f, 1, 4, 10);
+
+    printf("The updated array is : \n");
+    for(i = 0; i < n; i++){
+        segtree_query(t, i, i + 1, &res);
+        printf("arr[%d] = %lld\n", i, res.sum);
+    }
+
+    segtree_query(t, 0, n, &res);
+    printf("\nSum = %lld (Fenwick %lld), min = %lld, max = %lld\n",
+           res.sum, fenwick_sum(f, 0, n), res.min, res.max);
+
+    segtree_free(t);
+    fenwick_free(f);
+    return 0;
+}
@@ -0,0 +1,572 @@
+// Tiered vector : a growable array with fast insert and delete at any position.
+
+// Insertion.c and Deletion.c shift every element after the position, O(n)
+// per edit. Here the elements live in blocks of B = 2^shift ints, every block
+// is full except the last one, and every block is a circular buffer :
+//  - index i      -> block i / B, offset i % B from the block's head. O(1).
+//  - insert at i  -> each block after i's block hands its last element to
+//                    the front of the next one (O(1) per block thanks to the
+//                    circular buffer), then i's block shifts its shorter side
+//                    by one. O(B + n / B).
+//  - delete at i  -> the same the other way.
+// B follows sqrt(n) (the blocks are rebuilt when n leaves [B^2 / 64, B^2 / 4]),
+// so an edit is O(sqrt n). The blocks stay contiguous, tv_chunk() gives the
+// runs for scans.
+// Range operations move the tail once, O(n - pos + m), when that is cheaper
+// than m single edits.
+
+// Input : arr[] = {16, 6, 8, 32, 12}, insert 99 at position 4, delete position 3
+// Output : arr[0] = 16 arr[1] = 6 arr[2] = 99 arr[3] = 32 arr[4] = 12
+
+// Time Complexity : O(1) index, O(sqrt n) insert / delete
+// Space Complexity : O(n + sqrt n)
+
+// Compile : gcc -O2 Tiered_Vector.c -o tiered_vector
+// Run     : ./tiered_vector              (small example)
+//           ./tiered_vector bench [logn] (random edits against shifting)
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<time.h>
+
+// Smallest blocks : 64 ints
+#define TV_MIN_SHIFT 6
+
+struct tiered_vector
+{
+    int **blocks;
+    size_t *head;               // first element of block b is blocks[b][head[b]]
+    size_t block_count;         // blocks in use
+    size_t block_room;          // slots in blocks[] and head[]
+    size_t size;
+    unsigned shift;             // blocks hold 1 << shift ints
+    int *spare;                 // emptied block kept for the next growth
+};
+
+#define TV_MASK(tv) (((size_t)1 << (tv)->shift) - 1)
+
+struct tiered_vector *tv_create(void)
+{
+    struct tiered_vector *tv = (struct tiered_vector *)calloc(1, sizeof(struct tiered_vector));
+
+    if (tv != NULL)
+    {
+        tv->shift = TV_MIN_SHIFT;
+    }
+    return tv;
+}
+
+void tv_free(struct tiered_vector *tv)
+{
+    size_t b;
+
+    if (tv == NULL)
+    {
+        return;
+    }
+    for (b = 0; b < tv->block_count; b++)
+    {
+        free(tv->blocks[b]);
+    }
+    free(tv->spare);
+    free(tv->blocks);
+    free(tv->head);
+    free(tv);
+}
+
+size_t tv_size(const struct tiered_vector *tv)
+{
+    return tv->size;
+}
+
+int tv_get(const struct tiered_vector *tv, size_t i)
+{
+    size_t b = i >> tv->shift;
+
+    return tv->blocks[b][(tv->head[b] + i) & TV_MASK(tv)];
+}
+
+void tv_set(struct tiered_vector *tv, size_t i, int value)
+{
+    size_t b = i >> tv->shift;
+
+    tv->blocks[b][(tv->head[b] + i) & TV_MASK(tv)] = value;
+}
+
+// Contiguous run starting at index i : *run points to it, returns its length
+size_t tv_chunk(const struct tiered_vector *tv, size_t i, const int **run)
+{
+    size_t b = i >> tv->shift, mask = TV_MASK(tv);
+    size_t slot = (tv->head[b] + i) & mask;
+    size_t in_block = ((b + 1) << tv->shift < tv->size) ? ((b + 1) << tv->shift) - i : tv->size - i;
+    size_t to_wrap = mask + 1 - slot;
+
+    *run = tv->blocks[b] + slot;
+    return (in_block < to_wrap) ? in_block : to_wrap;
+}
+
+static int add_block(struct tiered_vector *tv)
+{
+    int *block;
+
+    if (tv->block_count == tv->block_room)
+    {
+        size_t room = tv->block_room ? tv->block_room * 2 : 16;
+        int **blocks = (int **)realloc(tv->blocks, room * sizeof(int *));
+        size_t *head;
+
+        if (blocks == NULL)
+        {
+            return -1;
+        }
+        tv->blocks = blocks;
+        head = (size_t *)realloc(tv->head, room * sizeof(size_t));
+        if (head == NULL)
+        {
+            return -1;
+        }
+        tv->head = head;
+        tv->block_room = room;
+    }
+
+    block = tv->spare;
+    tv->spare = NULL;
+    if (block == NULL)
+    {
+        block = (int *)malloc(sizeof(int) << tv->shift);
+        if (block == NULL)
+        {
+            return -1;
+        }
+    }
+    tv->blocks[tv->block_count] = block;
+    tv->head[tv->block_count] = 0;
+    tv->block_count++;
+    return 0;
+}
+
+static void drop_last_block(struct tiered_vector *tv)
+{
+    int *block = tv->blocks[--tv->block_count];
+
+    if (tv->spare == NULL)
+    {
+        tv->spare = block;
+    }
+    else
+    {
+        free(block);
+    }
+}
+
+// Rebuilds with blocks of 1 << shift ints. On failure the vector is unchanged.
+static int rebuild(struct tiered_vector *tv, unsigned shift)
+{
+    struct tiered_vector fresh;
+    size_t i, b;
+
+    memset(&fresh, 0, sizeof(fresh));
+    fresh.shift = shift;
+
+    for (i = 0; i < tv->size; i++)
+    {
+        if ((i & TV_MASK(&fresh)) == 0 && add_block(&fresh) != 0)
+        {
+            for (b = 0; b < fresh.block_count; b++)
+            {
+                free(fresh.blocks[b]);
+            }
+            free(fresh.blocks);
+            free(fresh.head);
+            return -1;
+        }
+        fresh.blocks[i >> shift][i & TV_MASK(&fresh)] = tv_get(tv, i);
+    }
+    fresh.size = tv->size;
+
+    for (b = 0; b < tv->block_count; b++)
+    {
+        free(tv->blocks[b]);
+    }
+    free(tv->spare);
+    free(tv->blocks);
+    free(tv->head);
+    *tv = fresh;
+    return 0;
+}
+
+// Keeps B^2 / 64 <= n <= B^2 / 4, so B is 2 to 8 times sqrt(n) : the shift
+// inside a block walks memory in order, while every hand-over between blocks
+// is a cache miss.
+// A failed rebuild only costs speed.
+static void fit_block_size(struct tiered_vector *tv)
+{
+    size_t block = (size_t)1 << tv->shift;
+
+    if (tv->block_count > block / 4)
+    {
+        rebuild(tv, tv->shift + 1);
+    }
+    else if (tv->shift > TV_MIN_SHIFT && tv->size < block * block / 64)
+    {
+        rebuild(tv, tv->shift - 1);
+    }
+}
+
+int tv_push_back(struct tiered_vector *tv, int value)
+{
+    if (tv->size == tv->block_count << tv->shift && add_block(tv) != 0)
+    {
+        return -1;
+    }
+    tv->size++;
+    tv_set(tv, tv->size - 1, value);
+    fit_block_size(tv);
+    return 0;
+}
+
+// Drops the elements from new_size on
+static void truncate_to(struct tiered_vector *tv, size_t new_size)
+{
+    size_t needed = (new_size + TV_MASK(tv)) >> tv->shift;
+
+    tv->size = new_size;
+    while (tv->block_count > needed)
+    {
+        drop_last_block(tv);
+    }
+    fit_block_size(tv);
+}
+
+// Inserts value before index pos (pos = size appends). Returns -1 when pos is
+// out of range or memory runs out.
+int tv_insert(struct tiered_vector *tv, size_t pos, int value)
+{
+    size_t mask = TV_MASK(tv), b, k, last, count, offset, j;
+    int *block;
+
+    if (pos > tv->size)
+    {
+        return -1;
+    }
+    if (pos == tv->size)
+    {
+        return tv_push_back(tv, value);
+    }
+    if (tv->size == tv->block_count << tv->shift && add_block(tv) != 0)
+    {
+        return -1;
+    }
+
+    // Every block after b passes its last element to the next block's front
+    b = pos >> tv->shift;
+    last = tv->block_count - 1;
+    for (k = last; k > b; k--)
+    {
+        tv->head[k] = (tv->head[k] - 1) & mask;
+        tv->blocks[k][tv->head[k]] = tv->blocks[k - 1][(tv->head[k - 1] + mask) & mask];
+    }
+
+    block = tv->blocks[b];
+    count = (b == last) ? tv->size - (last << tv->shift) : mask;
+    offset = pos & mask;
+
+    // Open a hole at offset, moving the shorter side
+    if (offset < count - offset)
+    {
+        tv->head[b] = (tv->head[b] - 1) & mask;
+        for (j = 0; j < offset; j++)
+        {
+            block[(tv->head[b] + j) & mask] = block[(tv->head[b] + j + 1) & mask];
+        }
+    }
+    else
+    {
+        for (j = count; j > offset; j--)
+        {
+            block[(tv->head[b] + j) & mask] = block[(tv->head[b] + j - 1) & mask];
+        }
+    }
+    block[(tv->head[b] + offset) & mask] = value;
+
+    tv->size++;
+    fit_block_size(tv);
+    return 0;
+}
+
+// Removes the element at pos. Returns -1 when pos is out of range.
+int tv_erase(struct tiered_vector *tv, size_t pos)
+{
+    size_t mask = TV_MASK(tv), b, k, last, count, offset, j;
+    int *block;
+
+    if (pos >= tv->size)
+    {
+        return -1;
+    }
+
+    b = pos >> tv->shift;
+    last = tv->block_count - 1;
+    block = tv->blocks[b];
+    count = (b == last) ? tv->size - (last << tv->shift) : mask + 1;
+    offset = pos & mask;
+
+    // Close the hole at offset, moving the shorter side
+    if (offset < count - 1 - offset)
+    {
+        for (j = offset; j > 0; j--)
+        {
+            block[(tv->head[b] + j) & mask] = block[(tv->head[b] + j - 1) & mask];
+        }
+        tv->head[b] = (tv->head[b] + 1) & mask;
+    }
+    else
+    {
+        for (j = offset; j + 1 < count; j++)
+        {
+            block[(tv->head[b] + j) & mask] = block[(tv->head[b] + j + 1) & mask];
+        }
+    }
+
+    // Every block after b passes its first element to the previous block's back
+    for (k = b + 1; k <= last; k++)
+    {
+        tv->blocks[k - 1][(tv->head[k - 1] + mask) & mask] = tv->blocks[k][tv->head[k]];
+        tv->head[k] = (tv->head[k] + 1) & mask;
+    }
+
+    tv->size--;
+    if (tv->size == last << tv->shift)
+    {
+        drop_last_block(tv);
+    }
+    fit_block_size(tv);
+    return 0;
+}
+
+// Cost of m single edits against moving the tail once
+static int single_edits_cheaper(const struct tiered_vector *tv, size_t pos, size_t m)
+{
+    size_t per_edit = ((size_t)1 << tv->shift) / 2 + tv->block_count;
+
+    return m < (tv->size - pos + m) / per_edit;
+}
+
+// Inserts values[0 .. m) before index pos
+int tv_insert_range(struct tiered_vector *tv, size_t pos, const int values[], size_t m)
+{
+    size_t old_size = tv->size, j;
+
+    if (pos > tv->size)
+    {
+        return -1;
+    }
+    if (single_edits_cheaper(tv, pos, m))
+    {
+        for (j = 0; j < m; j++)
+        {
+            if (tv_insert(tv, pos + j, values[j]) != 0)
+            {
+                return -1;
+            }
+        }
+        return 0;
+    }
+
+    // Grow by m, move the tail up by m from the end, fill the gap
+    for (j = 0; j < m; j++)
+    {
+        if (tv_push_back(tv, values[j]) != 0)
+        {
+            truncate_to(tv, old_size);
+            return -1;
+        }
+    }
+    for (j = old_size; j > pos; j--)
+    {
+        tv_set(tv, j - 1 + m, tv_get(tv, j - 1));
+    }
+    for (j = 0; j < m; j++)
+    {
+        tv_set(tv, pos + j, values[j]);
+    }
+    return 0;
+}
+
+// Removes the m elements starting at pos
+int tv_erase_range(struct tiered_vector *tv, size_t pos, size_t m)
+{
+    size_t j;
+
+    if (pos > tv->size || m > tv->size - pos)
+    {
+        return -1;
+    }
+    if (single_edits_cheaper(tv, pos, m))
+    {
+        for (j = 0; j < m; j++)
+        {
+            tv_erase(tv, pos);
+        }
+        return 0;
+    }
+
+    for (j = pos; j + m < tv->size; j++)
+    {
+        tv_set(tv, j, tv_get(tv, j + m));
+    }
+    truncate_to(tv, tv->size - m);
+    return 0;
+}
+
+// ------------------------------------------------------------------
+// Benchmark
+// ------------------------------------------------------------------
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static unsigned long long rng_state = 88172645463325252ULL;
+
+static unsigned long long next_random(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return rng_state;
+}
+
+static void run_benchmark(int log_n)
+{
+    size_t n = (size_t)1 << log_n, i, len;
+    size_t tv_edits = 1 << 18, shift_edits = 1 << 10;
+    struct tiered_vector *tv = tv_create();
+    int *arr = (int *)malloc((n + 1) * sizeof(int));
+    long long sum[2] = {0, 0};
+    const int *run;
+    double t0, t_tv, t_shift, t_scan[2];
+
+    if (tv == NULL || arr == NULL)
+    {
+        printf("Out of memory.\n");
+        tv_free(tv);
+        free(arr);
+        return;
+    }
+    for (i = 0; i < n; i++)
+    {
+        arr[i] = (int)i;
+        if (tv_push_back(tv, (int)i) != 0)
+        {
+            printf("Out of memory.\n");
+            tv_free(tv);
+            free(arr);
+            return;
+        }
+    }
+
+    // Alternate a random insert and a random delete, so n stays the same
+    t0 = now_seconds();
+    for (i = 0; i < tv_edits; i++)
+    {
+        tv_insert(tv, next_random() % (n + 1), (int)i);
+        tv_erase(tv, next_random() % (n + 1));
+    }
+    t_tv = (now_seconds() - t0) / (2 * tv_edits);
+
+    t0 = now_seconds();
+    for (i = 0; i < shift_edits; i++)
+    {
+        size_t pos = next_random() % (n + 1);
+
+        memmove(arr + pos + 1, arr + pos, (n - pos) * sizeof(int));
+        arr[pos] = (int)i;
+        pos = next_random() % (n + 1);
+        memmove(arr + pos, arr + pos + 1, (n - pos) * sizeof(int));
+    }
+    t_shift = (now_seconds() - t0) / (2 * shift_edits);
+
+    t0 = now_seconds();
+    for (i = 0; i < n; i += len)
+    {
+        size_t j;
+
+        len = tv_chunk(tv, i, &run);
+        for (j = 0; j < len; j++)
+        {
+            sum[0] += run[j];
+        }
+    }
+    t_scan[0] = now_seconds() - t0;
+
+    t0 = now_seconds();
+    for (i = 0; i < n; i++)
+    {
+        sum[1] += arr[i];
+    }
+    t_scan[1] = now_seconds() - t0;
+
+    printf("n = %zu, blocks of %d ints\n", n, 1 << tv->shift);
+    printf("  tiered vector edit : %10.1f ns\n", t_tv * 1e9);
+    printf("  shifting edit      : %10.1f ns\n", t_shift * 1e9);
+    printf("  scan               : %6.2f GB/s tiered, %6.2f GB/s flat (sums %lld %lld)\n",
+           n * sizeof(int) / t_scan[0] * 1e-9, n * sizeof(int) / t_scan[1] * 1e-9, sum[0], sum[1]);
+
+    tv_free(tv);
+    free(arr);
+}
+
+static void print_vector(const struct tiered_vector *tv)
+{
+    size_t i;
+
+    for (i = 0; i < tv_size(tv); i++)
+    {
+        printf("arr[%zu] = %d ", i, tv_get(tv, i));
+    }
+    printf("\n\n");
+}
+
+int main(int argc, char *argv[])
+{
+    int arr[] = {16, 6, 8, 32, 12};
+    int more[] = {1, 2, 3};
+    struct tiered_vector *tv;
+    size_t i;
+
+    if (argc > 1 && strcmp(argv[1], "bench") == 0)
+    {
+        run_benchmark(argc > 2 ? atoi(argv[2]) : 23);
+        return 0;
+    }
+
+    tv = tv_create();
+    if (tv == NULL)
+    {
+        printf("Out of memory.\n");
+        return 1;
+    }
+    for (i = 0; i < sizeof(arr) / sizeof(arr[0]); i++)
+    {
+        tv_push_back(tv, arr[i]);
+    }
+    print_vector(tv);
+
+    // Position 4 and 3 are 1-based, as in Insertion.c and Deletion.c
+    tv_insert(tv, 4 - 1, 99);
+    tv_erase(tv, 3 - 1);
+    print_vector(tv);
+
+    tv_insert_range(tv, 1, more, 3);
+    tv_erase_range(tv, 5, 2);
+    print_vector(tv);
+
+    tv_free(tv);
+    return 0;
+}
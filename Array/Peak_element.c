@@ -1,36 +1,368 @@
 // // Find a peak element which is not smaller then its neighbours.
 
+// Input : arr[] = {10, 20, 15, 2, 23, 90, 90, 10}
+// Output : The peak element is = 90, the peak elements is : 20 90 90
+
+// One peak, 1D : find_peak() binary searches on the slope. If arr[mid] <
+// arr[mid + 1] the values keep rising to the right, so there is a peak in
+// (mid, n) ; otherwise there is one in [0, mid]. O(log n).
+
+// One peak, 2D (row-major grid, `stride` ints between rows) : find_peak_2d()
+// keeps a window known to hold a peak. Each step scans the middle row and
+// the middle column of the window and takes their maximum m. If m is not
+// smaller than its neighbours it is a peak ; otherwise the window becomes the
+// quarter holding the bigger neighbour (or the quarter of a previous cell
+// that was bigger still). The climb from that cell can never leave the
+// quarter, since it is bigger than every cell already scanned around it.
+// The window halves both ways every step : O(rows + cols).
+
+// All local maxima : local_maxima() / local_maxima_2d() compare every cell
+// with its neighbours 8 (AVX2) or 16 (AVX-512) cells at a time, the matching
+// indices come from the compare masks. O(n).
+
+// Compile : gcc -O2 Peak_element.c -o peak
+
 #include<stdio.h>
+#include<stdlib.h>
 
-int main()
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HAVE_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+// Index of a peak, or n for an empty array
+size_t find_peak(const int arr[], size_t n)
 {
-    int arr[] = {10, 20, 15, 2, 23, 90, 90,10};
-    int i,  size = sizeof(arr) / sizeof(arr[0]);
+    size_t low = 0, high;
+
+    if (n == 0)
+    {
+        return n;
+    }
+
+    high = n - 1;
+    while (low < high)
+    {
+        size_t mid = low + (high - low) / 2;
+
+        if (arr[mid] < arr[mid + 1])
+        {
+            low = mid + 1;
+        }
+        else
+        {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+// ------------------------------------------------------------------
+// 2D peak
+// ------------------------------------------------------------------
 
-    if (size == 1)
+#define CELL(grid, stride, r, c) ((grid)[(size_t)(r) * (stride) + (c)])
+
+// Biggest neighbour of (r, c) that is bigger than it. Returns 0 when there is
+// none, i.e. (r, c) is a peak.
+static int bigger_neighbour(const int *grid, size_t rows, size_t cols, size_t stride,
+                            size_t r, size_t c, size_t *nr, size_t *nc)
+{
+    int best = CELL(grid, stride, r, c), found = 0;
+
+    if (r > 0 && CELL(grid, stride, r - 1, c) > best)
+    {
+        best = CELL(grid, stride, r - 1, c);
+        *nr = r - 1;
+        *nc = c;
+        found = 1;
+    }
+    if (r + 1 < rows && CELL(grid, stride, r + 1, c) > best)
+    {
+        best = CELL(grid, stride, r + 1, c);
+        *nr = r + 1;
+        *nc = c;
+        found = 1;
+    }
+    if (c > 0 && CELL(grid, stride, r, c - 1) > best)
     {
-        printf("\nThe array has only one element.\n");
+        best = CELL(grid, stride, r, c - 1);
+        *nr = r;
+        *nc = c - 1;
+        found = 1;
     }
-    else if (arr[0] > arr[1])
+    if (c + 1 < cols && CELL(grid, stride, r, c + 1) > best)
     {
-        printf("\nThe peak element is = %d ",arr[0]);
+        *nr = r;
+        *nc = c + 1;
+        found = 1;
     }
-    else if (arr[size - 1] > arr[size - 2])
+    return found;
+}
+
+// Finds a cell not smaller than its 4 neighbours, stores it in *row, *col.
+// Returns -1 for an empty grid.
+int find_peak_2d(const int *grid, size_t rows, size_t cols, size_t stride, size_t *row, size_t *col)
+{
+    // Window [r0, r1) x [c0, c1), and the best cell seen outside the crosses
+    size_t r0 = 0, r1 = rows, c0 = 0, c1 = cols;
+    size_t gr = 0, gc = 0;
+    int have_best = 0;
+
+    if (rows == 0 || cols == 0)
     {
-        printf("\nThe peak element is = %d ",arr[size - 1]);
+        return -1;
     }
-    else
-    {   
-        printf("\nThe peak elements is : ");
-        for ( i = 1; i < size; i++)
+
+    for (;;)
+    {
+        size_t mr = r0 + (r1 - r0) / 2, mc = c0 + (c1 - c0) / 2;
+        size_t br = mr, bc = c0, r, c;
+
+        // Maximum of the middle row and the middle column
+        for (c = c0; c < c1; c++)
         {
-            if (arr[i] >= arr[i - 1] && arr[i] >= arr[i+1])
+            if (CELL(grid, stride, mr, c) > CELL(grid, stride, br, bc))
             {
-                printf("%d ",arr[i]);
+                bc = c;
             }
-            
+        }
+        for (r = r0; r < r1; r++)
+        {
+            if (CELL(grid, stride, r, mc) > CELL(grid, stride, br, bc))
+            {
+                br = r;
+                bc = mc;
+            }
+        }
+
+        if (!have_best || CELL(grid, stride, gr, gc) <= CELL(grid, stride, br, bc))
+        {
+            size_t nr, nc;
+
+            if (!bigger_neighbour(grid, rows, cols, stride, br, bc, &nr, &nc))
+            {
+                *row = br;
+                *col = bc;
+                return 0;
+            }
+            gr = nr;
+            gc = nc;
+            have_best = 1;
+        }
+
+        // Quarter holding (gr, gc). It is never on the cross : it is bigger
+        // than everything there.
+        if (gr < mr)
+        {
+            r1 = mr;
+        }
+        else
+        {
+            r0 = mr + 1;
+        }
+        if (gc < mc)
+        {
+            c1 = mc;
+        }
+        else
+        {
+            c0 = mc + 1;
         }
     }
-    
+}
+
+// ------------------------------------------------------------------
+// All local maxima
+// ------------------------------------------------------------------
+
+static int is_local_max(const int *grid, size_t rows, size_t cols, size_t stride, size_t r, size_t c)
+{
+    size_t nr, nc;
+
+    return !bigger_neighbour(grid, rows, cols, stride, r, c, &nr, &nc);
+}
+
+// Columns [1, cols - 1) of one row ; up / down are NULL at the grid edges.
+// Writes base + c for every local maximum, returns how many.
+typedef size_t (*row_kernel)(const int *, const int *, const int *, size_t, size_t, size_t *);
+
+static size_t row_maxima_scalar(const int *row, const int *up, const int *down,
+                                size_t cols, size_t base, size_t out[])
+{
+    size_t c, count = 0;
+
+    for (c = 1; c + 1 < cols; c++)
+    {
+        int x = row[c];
+
+        if (x >= row[c - 1] && x >= row[c + 1] && (up == NULL || x >= up[c]) && (down == NULL || x >= down[c]))
+        {
+            out[count++] = base + c;
+        }
+    }
+    return count;
+}
+
+#ifdef HAVE_X86_SIMD
+
+__attribute__((target("avx2,bmi")))
+static size_t row_maxima_avx2(const int *row, const int *up, const int *down,
+                              size_t cols, size_t base, size_t out[])
+{
+    size_t c = 1, count = 0;
+
+    for (; c + 8 < cols; c += 8)
+    {
+        __m256i x = _mm256_loadu_si256((const __m256i *)(row + c));
+        // x >= y is !(y > x)
+        __m256i smaller = _mm256_or_si256(_mm256_cmpgt_epi32(_mm256_loadu_si256((const __m256i *)(row + c - 1)), x),
+                                          _mm256_cmpgt_epi32(_mm256_loadu_si256((const __m256i *)(row + c + 1)), x));
+        unsigned mask;
+
+        if (up != NULL)
+        {
+            smaller = _mm256_or_si256(smaller, _mm256_cmpgt_epi32(_mm256_loadu_si256((const __m256i *)(up + c)), x));
+        }
+        if (down != NULL)
+        {
+            smaller = _mm256_or_si256(smaller, _mm256_cmpgt_epi32(_mm256_loadu_si256((const __m256i *)(down + c)), x));
+        }
+
+        mask = ~(unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(smaller)) & 0xFF;
+        while (mask != 0)
+        {
+            out[count++] = base + c + __builtin_ctz(mask);
+            mask &= mask - 1;
+        }
+    }
+
+    // Rest of the row, with row[c - 1] as the left neighbour
+    return count + row_maxima_scalar(row + c - 1, up ? up + c - 1 : NULL, down ? down + c - 1 : NULL,
+                                     cols - (c - 1), base + c - 1, out + count);
+}
+
+__attribute__((target("avx512f")))
+static size_t row_maxima_avx512(const int *row, const int *up, const int *down,
+                                size_t cols, size_t base, size_t out[])
+{
+    size_t c = 1, count = 0;
+
+    for (; c + 16 < cols; c += 16)
+    {
+        __m512i x = _mm512_loadu_si512((const void *)(row + c));
+        unsigned mask = _mm512_cmpge_epi32_mask(x, _mm512_loadu_si512((const void *)(row + c - 1)))
+                      & _mm512_cmpge_epi32_mask(x, _mm512_loadu_si512((const void *)(row + c + 1)));
+
+        if (up != NULL)
+        {
+            mask &= _mm512_cmpge_epi32_mask(x, _mm512_loadu_si512((const void *)(up + c)));
+        }
+        if (down != NULL)
+        {
+            mask &= _mm512_cmpge_epi32_mask(x, _mm512_loadu_si512((const void *)(down + c)));
+        }
+
+        while (mask != 0)
+        {
+            out[count++] = base + c + __builtin_ctz(mask);
+            mask &= mask - 1;
+        }
+    }
+
+    return count + row_maxima_scalar(row + c - 1, up ? up + c - 1 : NULL, down ? down + c - 1 : NULL,
+                                     cols - (c - 1), base + c - 1, out + count);
+}
+
+#endif
+
+static row_kernel get_row_kernel(void)
+{
+    static row_kernel kernel = NULL;
+
+    if (kernel == NULL)
+    {
+        kernel = row_maxima_scalar;
+#ifdef HAVE_X86_SIMD
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f"))
+        {
+            kernel = row_maxima_avx512;
+        }
+        else if (__builtin_cpu_supports("avx2"))
+        {
+            kernel = row_maxima_avx2;
+        }
+#endif
+    }
+    return kernel;
+}
+
+// Every cell not smaller than its 4 neighbours, as r * cols + c in row-major
+// order. out[] needs room for rows * cols (a flat grid is all maxima).
+size_t local_maxima_2d(const int *grid, size_t rows, size_t cols, size_t stride, size_t out[])
+{
+    row_kernel kernel = get_row_kernel();
+    size_t r, count = 0;
+
+    for (r = 0; r < rows; r++)
+    {
+        const int *row = grid + r * stride;
+        const int *up = (r > 0) ? row - stride : NULL;
+        const int *down = (r + 1 < rows) ? row + stride : NULL;
+
+        if (is_local_max(grid, rows, cols, stride, r, 0))
+        {
+            out[count++] = r * cols;
+        }
+        if (cols > 2)
+        {
+            count += kernel(row, up, down, cols, r * cols, out + count);
+        }
+        if (cols > 1 && is_local_max(grid, rows, cols, stride, r, cols - 1))
+        {
+            out[count++] = r * cols + cols - 1;
+        }
+    }
+    return count;
+}
+
+// Every index not smaller than its neighbours. out[] needs room for n.
+size_t local_maxima(const int arr[], size_t n, size_t out[])
+{
+    return local_maxima_2d(arr, (n > 0) ? 1 : 0, n, n, out);
+}
+
+int main()
+{
+    int arr[] = {10, 20, 15, 2, 23, 90, 90,10};
+    int grid[4][5] = {
+        { 1,  2,  3,  4,  5},
+        {14, 13, 12, 11,  6},
+        {15, 24, 25, 10,  7},
+        {16, 17, 18,  9,  8}
+    };
+    size_t i, peaks[20], row, col, size = sizeof(arr) / sizeof(arr[0]), count;
+
+    printf("\nThe peak element is = %d ", arr[find_peak(arr, size)]);
+
+    count = local_maxima(arr, size, peaks);
+    printf("\nThe peak elements is : ");
+    for ( i = 0; i < count; i++)
+    {
+        printf("%d ", arr[peaks[i]]);
+    }
+
+    find_peak_2d(&grid[0][0], 4, 5, 5, &row, &col);
+    printf("\nA 2D peak is = %d at (%zu, %zu)", grid[row][col], row, col);
+
+    count = local_maxima_2d(&grid[0][0], 4, 5, 5, peaks);
+    printf("\nThe 2D peak elements is : ");
+    for ( i = 0; i < count; i++)
+    {
+        printf("%d ", grid[peaks[i] / 5][peaks[i] % 5]);
+    }
+    printf("\n");
+
     return 0;
 }
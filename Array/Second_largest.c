@@ -1,31 +1,601 @@
+// Find the largest and the second largest element of an array.
+// Generalized to the k largest elements (top-k), with their indices.
+
+// Input : arr[] = {5, 2, 1, 6, 4, 8, 12, 10}
+// Output : The top most element is = 12, second largest element is = 10
+
+// The result is sorted by value, largest first ; equal values keep the
+// smaller index first.
+//  - Streaming (topk_stream_*) : a min-heap holds the k best so far, its root
+//    is the threshold to beat. Once the heap is full, the input is scanned
+//    8 (AVX2) or 16 (AVX-512) values at a time against the threshold and only
+//    a value above it touches the heap. For random input that is about
+//    k * ln(n / k) values out of n, the rest costs one compare per vector.
+//  - Whole array, large k (topk_select) : Floyd-Rivest selection in place.
+//    It picks two pivots from a small sample so that the k-th element almost
+//    surely falls between them, partitions, and recurses on the small middle.
+//    About n + min(k, n - k) compares, then the k winners are sorted.
+//  - topk() picks between the two, topk_parallel() runs topk() on one chunk
+//    per thread and selects the final k from the threads' winners.
+
+// Time Complexity : O(n + k log k log(n / k)) streaming, O(n + k log k) selection
+// Space Complexity : O(k) streaming, O(n) selection (an index per element)
+
+// Compile : gcc -O2 -pthread Second_largest.c -o top_k -lm
+// Run     : ./top_k              (small example)
+//           ./top_k bench [logn] (heap, SIMD heap, selection, threads)
+
 #include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<math.h>
+#include<time.h>
+#include<pthread.h>
+#include<unistd.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HAVE_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+#define MAX_THREADS 64
+
+// Smallest chunk worth a thread
+#define MIN_CHUNK (1 << 16)
+
+struct topk_item
+{
+    int value;
+    size_t index;
+};
+
+// a comes before b in the result
+static int before(const struct topk_item *a, const struct topk_item *b)
+{
+    return a->value > b->value || (a->value == b->value && a->index < b->index);
+}
+
+static int compare_items(const void *a, const void *b)
+{
+    return before((const struct topk_item *)b, (const struct topk_item *)a)
+         - before((const struct topk_item *)a, (const struct topk_item *)b);
+}
+
+static void swap_items(struct topk_item *a, struct topk_item *b)
+{
+    struct topk_item t = *a;
+
+    *a = *b;
+    *b = t;
+}
+
+// ------------------------------------------------------------------
+// Heap path. The root is the worst of the k kept items.
+// ------------------------------------------------------------------
+
+static void sift_down(struct topk_item heap[], size_t count, size_t i)
+{
+    for (;;)
+    {
+        size_t worst = i, child = 2 * i + 1;
+
+        if (child < count && before(&heap[worst], &heap[child]))
+        {
+            worst = child;
+        }
+        if (child + 1 < count && before(&heap[worst], &heap[child + 1]))
+        {
+            worst = child + 1;
+        }
+        if (worst == i)
+        {
+            return;
+        }
+        swap_items(&heap[i], &heap[worst]);
+        i = worst;
+    }
+}
 
-int main(){
-    int arr[10] = {5, 2, 1, 6, 4, 8, 12, 10};
-    int i, n = 8, max1, max2;
+static void sift_up(struct topk_item heap[], size_t i)
+{
+    while (i > 0 && before(&heap[(i - 1) / 2], &heap[i]))
+    {
+        swap_items(&heap[i], &heap[(i - 1) / 2]);
+        i = (i - 1) / 2;
+    }
+}
 
-    if(arr[0] > arr[1]){
-        max1 = arr[0];
-        max2 = arr[1];
-    }else{
-        max1 = arr[1];
-        max2 = arr[0];
+// First index in [from, n) whose value is > threshold, or n
+static size_t next_above_scalar(const int v[], size_t from, size_t n, int threshold)
+{
+    while (from < n && v[from] <= threshold)
+    {
+        from++;
     }
+    return from;
+}
+
+#ifdef HAVE_X86_SIMD
+
+__attribute__((target("avx2,bmi")))
+static size_t next_above_avx2(const int v[], size_t from, size_t n, int threshold)
+{
+    __m256i t = _mm256_set1_epi32(threshold);
+
+    for (; from + 16 <= n; from += 16)
+    {
+        __m256i a = _mm256_cmpgt_epi32(_mm256_loadu_si256((const __m256i *)(v + from)), t);
+        __m256i b = _mm256_cmpgt_epi32(_mm256_loadu_si256((const __m256i *)(v + from + 8)), t);
+        unsigned mask = (unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(a))
+                      | (unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(b)) << 8;
 
-    for(i = 2; i <= n; i++){
+        if (mask != 0)
+        {
+            return from + __builtin_ctz(mask);
+        }
+    }
+    return next_above_scalar(v, from, n, threshold);
+}
 
-        if(arr[i] > max1){
+__attribute__((target("avx512f,bmi")))
+static size_t next_above_avx512(const int v[], size_t from, size_t n, int threshold)
+{
+    __m512i t = _mm512_set1_epi32(threshold);
 
-            max2 = max1;
-            max1 = arr[i];
+    for (; from + 32 <= n; from += 32)
+    {
+        unsigned mask = (unsigned)_mm512_cmpgt_epi32_mask(_mm512_loadu_si512((const void *)(v + from)), t)
+                      | (unsigned)_mm512_cmpgt_epi32_mask(_mm512_loadu_si512((const void *)(v + from + 16)), t) << 16;
 
+        if (mask != 0)
+        {
+            return from + __builtin_ctz(mask);
         }
-        else if (arr[i] > max2)
+    }
+    return next_above_scalar(v, from, n, threshold);
+}
+
+#endif
+
+typedef size_t (*scan_kernel)(const int *, size_t, size_t, int);
+
+static scan_kernel get_scan(void)
+{
+    static scan_kernel kernel = NULL;
+
+    if (kernel == NULL)
+    {
+        kernel = next_above_scalar;
+#ifdef HAVE_X86_SIMD
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f"))
         {
-            max2 = arr[i];
+            kernel = next_above_avx512;
         }
+        else if (__builtin_cpu_supports("avx2"))
+        {
+            kernel = next_above_avx2;
+        }
+#endif
+    }
+    return kernel;
+}
+
+struct topk_stream
+{
+    struct topk_item *heap;
+    size_t k, count;
+    size_t seen;                // values pushed so far, the next index
+};
+
+// Returns -1 when memory runs out
+int topk_stream_init(struct topk_stream *s, size_t k)
+{
+    s->k = k;
+    s->count = 0;
+    s->seen = 0;
+    s->heap = (struct topk_item *)malloc((k ? k : 1) * sizeof(struct topk_item));
+    return (s->heap == NULL) ? -1 : 0;
+}
+
+void topk_stream_free(struct topk_stream *s)
+{
+    free(s->heap);
+    s->heap = NULL;
+}
+
+static void stream_consume(struct topk_stream *s, const int values[], size_t n, scan_kernel scan)
+{
+    size_t i = 0;
+
+    while (i < n && s->count < s->k)
+    {
+        s->heap[s->count].value = values[i];
+        s->heap[s->count].index = s->seen + i;
+        sift_up(s->heap, s->count++);
+        i++;
+    }
+
+    // A value equal to the root comes later, so it loses the tie
+    while (s->k > 0 && (i = scan(values, i, n, s->heap[0].value)) < n)
+    {
+        s->heap[0].value = values[i];
+        s->heap[0].index = s->seen + i;
+        sift_down(s->heap, s->count, 0);
+        i++;
+    }
+    s->seen += n;
+}
+
+// Values of the next n positions of the stream
+void topk_stream_push(struct topk_stream *s, const int values[], size_t n)
+{
+    stream_consume(s, values, n, get_scan());
+}
+
+// The kept items, best first, into out[] (room for k). Returns how many.
+size_t topk_stream_result(const struct topk_stream *s, struct topk_item out[])
+{
+    memcpy(out, s->heap, s->count * sizeof(struct topk_item));
+    qsort(out, s->count, sizeof(struct topk_item), compare_items);
+    return s->count;
+}
+
+// ------------------------------------------------------------------
+// Selection path : Floyd-Rivest
+// ------------------------------------------------------------------
+
+// Moves the item of rank k (0 = best) to a[k], better ones before it, worse
+// ones after it, within a[left .. right].
+static void floyd_rivest(struct topk_item a[], long left, long right, long k)
+{
+    while (right > left)
+    {
+        struct topk_item t;
+        long i, j;
+
+        // Narrow [left, right] around k with a sample first
+        if (right - left > 600)
+        {
+            double n = right - left + 1, rank = k - left + 1;
+            double z = log(n), s = 0.5 * exp(2 * z / 3);
+            double sd = 0.5 * sqrt(z * s * (n - s) / n) * (rank < n / 2 ? -1 : 1);
+            long new_left = (long)(k - rank * s / n + sd);
+            long new_right = (long)(k + (n - rank) * s / n + sd);
+
+            floyd_rivest(a, (new_left > left) ? new_left : left, (new_right < right) ? new_right : right, k);
+        }
+
+        t = a[k];
+        i = left;
+        j = right;
+        swap_items(&a[left], &a[k]);
+        if (before(&t, &a[right]))
+        {
+            swap_items(&a[right], &a[left]);
+        }
+        while (i < j)
+        {
+            swap_items(&a[i], &a[j]);
+            i++;
+            j--;
+            while (before(&a[i], &t))
+            {
+                i++;
+            }
+            while (before(&t, &a[j]))
+            {
+                j--;
+            }
+        }
+
+        // Every item is unique (index), so "equal" means it is t itself
+        if (a[left].index == t.index)
+        {
+            swap_items(&a[left], &a[j]);
+        }
+        else
+        {
+            j++;
+            swap_items(&a[j], &a[right]);
+        }
+
+        if (j <= k)
+        {
+            left = j + 1;
+        }
+        if (k <= j)
+        {
+            right = j - 1;
+        }
+    }
+}
+
+// In place : items[0 .. k) become the k best, sorted best first
+void topk_select(struct topk_item items[], size_t n, size_t k)
+{
+    if (k >= n)
+    {
+        k = n;
+    }
+    else if (k > 0)
+    {
+        floyd_rivest(items, 0, (long)n - 1, (long)k - 1);
+    }
+    qsort(items, k, sizeof(struct topk_item), compare_items);
+}
+
+// ------------------------------------------------------------------
+// Entry points
+// ------------------------------------------------------------------
+
+// The k largest of arr[0 .. n) into out[] (room for k), best first.
+// Returns min(k, n), or 0 when memory runs out.
+size_t topk(const int arr[], size_t n, size_t k, struct topk_item out[])
+{
+    size_t i;
+
+    if (k > n)
+    {
+        k = n;
+    }
+
+    // Small k : the filtered heap reads the array once and rejects most of it
+    if (k * 16 <= n)
+    {
+        struct topk_stream s;
+
+        if (topk_stream_init(&s, k) != 0)
+        {
+            return 0;
+        }
+        topk_stream_push(&s, arr, n);
+        topk_stream_result(&s, out);
+        topk_stream_free(&s);
+    }
+    else
+    {
+        struct topk_item *items = (struct topk_item *)malloc((n ? n : 1) * sizeof(struct topk_item));
+
+        if (items == NULL)
+        {
+            return 0;
+        }
+        for (i = 0; i < n; i++)
+        {
+            items[i].value = arr[i];
+            items[i].index = i;
+        }
+        topk_select(items, n, k);
+        memcpy(out, items, k * sizeof(struct topk_item));
+        free(items);
+    }
+    return k;
+}
+
+struct topk_chunk
+{
+    const int *arr;
+    size_t begin, n, k;
+    struct topk_item *out;
+    size_t found;
+};
+
+static void *topk_worker(void *arg)
+{
+    struct topk_chunk *c = (struct topk_chunk *)arg;
+    size_t i;
+
+    c->found = topk(c->arr + c->begin, c->n, c->k, c->out);
+    for (i = 0; i < c->found; i++)
+    {
+        c->out[i].index += c->begin;
+    }
+    return NULL;
+}
+
+// Same result as topk(), with up to `threads` threads : every thread keeps
+// the top-k of its chunk, then the best k of those are selected.
+size_t topk_parallel(const int arr[], size_t n, size_t k, struct topk_item out[], int threads)
+{
+    struct topk_chunk chunks[MAX_THREADS];
+    pthread_t tid[MAX_THREADS];
+    int started[MAX_THREADS];
+    struct topk_item *all;
+    size_t chunk, total = 0;
+    int t, ok = 1;
+
+    if (threads > MAX_THREADS)
+    {
+        threads = MAX_THREADS;
+    }
+    if ((size_t)threads > n / MIN_CHUNK)
+    {
+        threads = (int)(n / MIN_CHUNK);
+    }
+    if (k > n)
+    {
+        k = n;
+    }
+    if (threads <= 1)
+    {
+        return topk(arr, n, k, out);
+    }
+
+    all = (struct topk_item *)malloc(threads * k * sizeof(struct topk_item));
+    if (all == NULL)
+    {
+        return 0;
+    }
+    get_scan();
+
+    chunk = (n + threads - 1) / threads;
+    for (t = 0; t < threads; t++)
+    {
+        chunks[t].arr = arr;
+        chunks[t].begin = t * chunk;
+        chunks[t].n = (chunks[t].begin + chunk < n) ? chunk : n - chunks[t].begin;
+        chunks[t].k = k;
+        chunks[t].out = all + t * k;
+        started[t] = (pthread_create(&tid[t], NULL, topk_worker, &chunks[t]) == 0);
+        if (!started[t])
+        {
+            topk_worker(&chunks[t]);
+        }
+    }
+
+    // Gather the winners next to each other
+    for (t = 0; t < threads; t++)
+    {
+        if (started[t])
+        {
+            pthread_join(tid[t], NULL);
+        }
+        ok = ok && chunks[t].found == ((chunks[t].n < k) ? chunks[t].n : k);
+        memmove(all + total, chunks[t].out, chunks[t].found * sizeof(struct topk_item));
+        total += chunks[t].found;
+    }
+
+    if (!ok)
+    {
+        free(all);
+        return 0;
+    }
+    topk_select(all, total, k);
+    memcpy(out, all, k * sizeof(struct topk_item));
+    free(all);
+    return k;
+}
+
+// ------------------------------------------------------------------
+// Benchmark
+// ------------------------------------------------------------------
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static unsigned long long rng_state = 88172645463325252ULL;
+
+static unsigned long long next_random(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return rng_state;
+}
+
+static void run_benchmark(int log_n)
+{
+    size_t n = (size_t)1 << log_n, ks[] = {10, 1000, 10000}, i, r;
+    int threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    int *arr = (int *)malloc(n * sizeof(int));
+    struct topk_item *out = (struct topk_item *)malloc(10000 * sizeof(struct topk_item));
+    struct topk_item *items = (struct topk_item *)malloc(n * sizeof(struct topk_item));
+
+    if (arr == NULL || out == NULL || items == NULL)
+    {
+        printf("Out of memory.\n");
+        free(arr);
+        free(out);
+        free(items);
+        return;
+    }
+    for (i = 0; i < n; i++)
+    {
+        arr[i] = (int)(next_random() >> 33);
+    }
+    // One untimed selection, so the first row does not pay the page faults
+    for (i = 0; i < n; i++)
+    {
+        items[i].value = arr[i];
+        items[i].index = i;
+    }
+    topk_select(items, n, 1);
+
+    printf("n = %zu, times in ms\n", n);
+    printf("%8s %10s %10s %10s %10s\n", "k", "heap", "SIMD heap", "selection", "threads");
+    for (r = 0; r < sizeof(ks) / sizeof(ks[0]); r++)
+    {
+        size_t k = ks[r];
+        struct topk_stream s;
+        double t0, t[4];
+        int best[4];
+
+        // Not enough elements for this k
+        if (k > n)
+        {
+            continue;
+        }
+        if (topk_stream_init(&s, k) != 0)
+        {
+            break;
+        }
+        t0 = now_seconds();
+        stream_consume(&s, arr, n, next_above_scalar);
+        topk_stream_result(&s, out);
+        t[0] = now_seconds() - t0;
+        best[0] = out[k - 1].value;
+        topk_stream_free(&s);
+
+        topk_stream_init(&s, k);
+        t0 = now_seconds();
+        topk_stream_push(&s, arr, n);
+        topk_stream_result(&s, out);
+        t[1] = now_seconds() - t0;
+        best[1] = out[k - 1].value;
+        topk_stream_free(&s);
+
+        t0 = now_seconds();
+        for (i = 0; i < n; i++)
+        {
+            items[i].value = arr[i];
+            items[i].index = i;
+        }
+        topk_select(items, n, k);
+        t[2] = now_seconds() - t0;
+        best[2] = items[k - 1].value;
+
+        t0 = now_seconds();
+        topk_parallel(arr, n, k, out, threads);
+        t[3] = now_seconds() - t0;
+        best[3] = out[k - 1].value;
+
+        printf("%8zu %10.1f %10.1f %10.1f %10.1f%s\n", k, t[0] * 1e3, t[1] * 1e3, t[2] * 1e3, t[3] * 1e3,
+               (best[0] == best[1] && best[1] == best[2] && best[2] == best[3]) ? "" : "  MISMATCH");
+    }
+
+    free(arr);
+    free(out);
+    free(items);
+}
+
+int main(int argc, char *argv[])
+{
+    int arr[] = {5, 2, 1, 6, 4, 8, 12, 10};
+    struct topk_item best[3];
+    size_t i, n = sizeof(arr) / sizeof(arr[0]), found;
+
+    if (argc > 1 && strcmp(argv[1], "bench") == 0)
+    {
+        run_benchmark(argc > 2 ? atoi(argv[2]) : 26);
+        return 0;
+    }
+
+    found = topk(arr, n, 3, best);
+
+    printf("\nThe top most element is = %d", best[0].value);
+    printf("\nSecond largest element is = %d\n", best[1].value);
+
+    printf("Top %zu : ", found);
+    for (i = 0; i < found; i++)
+    {
+        printf("%d (index %zu) ", best[i].value, best[i].index);
     }
-    printf("\nThe top most element is = %d",max1);
-    printf("\nSecond largest element is = %d\n", max2);
+    printf("\n");
     return 0;
-}
\ No newline at end of file
+}
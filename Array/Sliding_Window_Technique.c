@@ -1,39 +1,368 @@
 // Using sliding Window technique we solve the maximum sub array problem
 
+// Input : arr[] = {1, 2, 4, 5, 6, 8, 10, 12}, subArraySize = 4
+// Output : The maximum sum is = 36, the sub array is : 6 8 10 12
+
+// Generalized to a streaming engine : values arrive in batches, from a stream
+// of any length, and several window sizes are followed at once. For every
+// window size and every value, once the window is full, the engine emits the
+// sum, average, min and max of the last `size` values.
+//  - sum : the new value is added and the one leaving the window subtracted.
+//  - min / max : monotonic deques of positions. The max deque keeps only the
+//    values that can still become the maximum (decreasing from the front),
+//    a new value pops every smaller one from the back, and the front drops
+//    out when it leaves the window. Each position is pushed and popped once,
+//    so a window costs amortized O(1) per value.
+// Only the last longest + ENGINE_BATCH values are kept (in a ring), and each
+// deque is a ring of `size` positions, so the memory does not grow with the
+// stream. For an array already in memory, the prefix sums of
+// Operations/Prefix_Sum.c (range_sums_build) give any window sum in O(1).
+
+// Time Complexity : O(windows) amortized per value
+// Space Complexity : O(sum of the window sizes + ENGINE_BATCH)
+
+// Compile : gcc -O2 Sliding_Window_Technique.c -o sliding_window
+// Run     : ./sliding_window              (small example)
+//           ./sliding_window bench [logn] (ns per value and window)
+
 #include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<time.h>
 
-int main()
+#define MAX_WINDOWS 16
+
+// Values handled per window before moving to the next window
+#define ENGINE_BATCH 1024
+
+struct window_result
 {
-    int arr[20] = {1, 2, 4, 5, 6, 8, 10, 12};
-    int i, subArraySize = 4, n = 8;
-    int current = 0, max, start_idx = 0;
+    long long sum;
+    double avg;
+    int min, max;
+};
+
+// Ring of positions, capacity is a power of two
+struct position_deque
+{
+    unsigned long long *pos;
+    size_t mask;
+    unsigned long long head, tail;  // front is pos[head & mask], size tail - head
+};
+
+struct window_state
+{
+    size_t size;
+    long long sum;
+    struct position_deque min, max;
+};
+
+struct window_engine
+{
+    int count;
+    int *history;                   // history[p & mask] is the value at position p
+    size_t mask;
+    unsigned long long seen;        // values pushed so far
+    struct window_state w[MAX_WINDOWS];
+};
+
+static size_t power_of_two_above(size_t n)
+{
+    size_t p = 1;
+
+    while (p < n)
+    {
+        p *= 2;
+    }
+    return p;
+}
+
+void window_engine_free(struct window_engine *e)
+{
+    int k;
+
+    if (e == NULL)
+    {
+        return;
+    }
+    for (k = 0; k < e->count; k++)
+    {
+        free(e->w[k].min.pos);
+        free(e->w[k].max.pos);
+    }
+    free(e->history);
+    free(e);
+}
+
+// Engine following count (1 to MAX_WINDOWS) window sizes, all > 0.
+// Returns NULL on bad arguments or when memory runs out.
+struct window_engine *window_engine_create(const size_t sizes[], int count)
+{
+    struct window_engine *e;
+    size_t longest = 0, capacity;
+    int k;
+
+    if (count <= 0 || count > MAX_WINDOWS)
+    {
+        return NULL;
+    }
+    for (k = 0; k < count; k++)
+    {
+        if (sizes[k] == 0)
+        {
+            return NULL;
+        }
+        longest = (sizes[k] > longest) ? sizes[k] : longest;
+    }
+
+    e = (struct window_engine *)calloc(1, sizeof(struct window_engine));
+    if (e == NULL)
+    {
+        return NULL;
+    }
+    e->count = count;
+
+    // A batch is written to the history before the windows read it, so the
+    // oldest value of the longest window must survive one more batch
+    capacity = power_of_two_above(longest + ENGINE_BATCH);
+    e->history = (int *)malloc(capacity * sizeof(int));
+    e->mask = capacity - 1;
+
+    for (k = 0; k < count; k++)
+    {
+        size_t ring = power_of_two_above(sizes[k]);
+
+        e->w[k].size = sizes[k];
+        e->w[k].min.pos = (unsigned long long *)malloc(ring * sizeof(unsigned long long));
+        e->w[k].max.pos = (unsigned long long *)malloc(ring * sizeof(unsigned long long));
+        e->w[k].min.mask = e->w[k].max.mask = ring - 1;
+        if (e->w[k].min.pos == NULL || e->w[k].max.pos == NULL)
+        {
+            window_engine_free(e);
+            return NULL;
+        }
+    }
+    if (e->history == NULL)
+    {
+        window_engine_free(e);
+        return NULL;
+    }
+    return e;
+}
+
+// One window over the positions [first, first + m), already in the history.
+// Appends one result per full window to out, returns how many.
+static size_t slide_window(struct window_engine *e, struct window_state *w,
+                           unsigned long long first, size_t m, struct window_result *out)
+{
+    const int *history = e->history;
+    size_t hmask = e->mask, emitted = 0, j;
+    struct position_deque *mn = &w->min, *mx = &w->max;
+
+    for (j = 0; j < m; j++)
+    {
+        unsigned long long p = first + j;
+        int x = history[p & hmask];
+
+        w->sum += x;
+        if (p >= w->size)
+        {
+            unsigned long long gone = p - w->size;
+
+            w->sum -= history[gone & hmask];
+            if (mn->head < mn->tail && mn->pos[mn->head & mn->mask] == gone)
+            {
+                mn->head++;
+            }
+            if (mx->head < mx->tail && mx->pos[mx->head & mx->mask] == gone)
+            {
+                mx->head++;
+            }
+        }
+
+        while (mn->head < mn->tail && history[mn->pos[(mn->tail - 1) & mn->mask] & hmask] >= x)
+        {
+            mn->tail--;
+        }
+        mn->pos[mn->tail++ & mn->mask] = p;
 
-    for ( i = 0; i < subArraySize; i++)
+        while (mx->head < mx->tail && history[mx->pos[(mx->tail - 1) & mx->mask] & hmask] <= x)
+        {
+            mx->tail--;
+        }
+        mx->pos[mx->tail++ & mx->mask] = p;
+
+        if (p + 1 >= w->size)
+        {
+            out[emitted].sum = w->sum;
+            out[emitted].avg = (double)w->sum / w->size;
+            out[emitted].min = history[mn->pos[mn->head & mn->mask] & hmask];
+            out[emitted].max = history[mx->pos[mx->head & mx->mask] & hmask];
+            emitted++;
+        }
+    }
+    return emitted;
+}
+
+// Pushes n values. out[k] receives the results of window k (room for n),
+// counts[k] how many were written : one per value once the window is full.
+void window_engine_push(struct window_engine *e, const int values[], size_t n,
+                        struct window_result *out[], size_t counts[])
+{
+    size_t done = 0, j;
+    int k;
+
+    for (k = 0; k < e->count; k++)
     {
-        current += arr[i];
+        counts[k] = 0;
     }
 
-    max = current;
+    while (done < n)
+    {
+        size_t m = (n - done < ENGINE_BATCH) ? n - done : ENGINE_BATCH;
 
-    for ( i = 1; i <= n - subArraySize; i++)
+        for (j = 0; j < m; j++)
+        {
+            e->history[(e->seen + j) & e->mask] = values[done + j];
+        }
+
+        // One window at a time, so its deques stay in cache for the batch
+        for (k = 0; k < e->count; k++)
+        {
+            counts[k] += slide_window(e, &e->w[k], e->seen, m, out[k] + counts[k]);
+        }
+
+        e->seen += m;
+        done += m;
+    }
+}
+
+// ------------------------------------------------------------------
+// Benchmark
+// ------------------------------------------------------------------
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static unsigned long long rng_state = 88172645463325252ULL;
+
+static unsigned long long next_random(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return rng_state;
+}
+
+static void run_benchmark(int log_n)
+{
+    size_t sizes[] = {16, 256, 4096, 65536};
+    int windows = sizeof(sizes) / sizeof(sizes[0]), k;
+    size_t total = (size_t)1 << log_n, batch = 4096, done, i, counts[MAX_WINDOWS];
+    struct window_engine *e = window_engine_create(sizes, windows);
+    struct window_result *out[MAX_WINDOWS];
+    int *values = (int *)malloc(batch * sizeof(int));
+    long long checksum = 0;
+    int ok = (e != NULL && values != NULL);
+    double t0, t;
+
+    for (k = 0; k < windows; k++)
+    {
+        out[k] = (struct window_result *)malloc(batch * sizeof(struct window_result));
+        ok = ok && out[k] != NULL;
+    }
+    if (!ok)
     {
-        current = current - arr[i-1] + arr[i + subArraySize - 1];
+        printf("Out of memory.\n");
+        for (k = 0; k < windows; k++)
+        {
+            free(out[k]);
+        }
+        free(values);
+        window_engine_free(e);
+        return;
+    }
+
+    t0 = now_seconds();
+    for (done = 0; done < total; done += batch)
+    {
+        for (i = 0; i < batch; i++)
+        {
+            values[i] = (int)(next_random() % 1000000);
+        }
+        window_engine_push(e, values, batch, out, counts);
+        for (k = 0; k < windows; k++)
+        {
+            checksum += (counts[k] > 0) ? out[k][counts[k] - 1].max : 0;
+        }
+    }
+    t = now_seconds() - t0;
+
+    printf("%zu values, %d windows (16 to 65536) : %.2f ns per value and window (check %lld)\n",
+           total, windows, t / total / windows * 1e9, checksum);
+
+    for (k = 0; k < windows; k++)
+    {
+        free(out[k]);
+    }
+    free(values);
+    window_engine_free(e);
+}
 
-        if (current > max)
+int main(int argc, char *argv[])
+{
+    int arr[20] = {1, 2, 4, 5, 6, 8, 10, 12};
+    size_t sizes[] = {4, 2, 3};
+    struct window_result results[3][8], *out[3] = { results[0], results[1], results[2] };
+    size_t i, counts[3], subArraySize = 4, n = 8, start_idx = 0;
+    struct window_engine *e;
+    long long max;
+
+    if (argc > 1 && strcmp(argv[1], "bench") == 0)
+    {
+        run_benchmark(argc > 2 ? atoi(argv[2]) : 26);
+        return 0;
+    }
+
+    e = window_engine_create(sizes, 3);
+    if (e == NULL)
+    {
+        printf("Out of memory.\n");
+        return 1;
+    }
+    window_engine_push(e, arr, n, out, counts);
+
+    // results[0][i] is the window arr[i .. i + subArraySize)
+    max = results[0][0].sum;
+    for ( i = 1; i < counts[0]; i++)
+    {
+        if (results[0][i].sum > max)
         {
-            max = current;
+            max = results[0][i].sum;
             start_idx = i;
         }
-        
     }
 
-    printf("The maximum sum is = %d ",max);
+    printf("The maximum sum is = %lld ",max);
     printf("\nThe sub array is : ");
     for ( i = start_idx; i < start_idx + subArraySize; i++)
     {
         printf("%d ",arr[i]);
     }
 
-    return 0;   
-     
-}
\ No newline at end of file
+    printf("\nWindow of 3, min / max / avg : ");
+    for ( i = 0; i < counts[2]; i++)
+    {
+        printf("%d/%d/%.1f ", results[2][i].min, results[2][i].max, results[2][i].avg);
+    }
+    printf("\n");
+
+    window_engine_free(e);
+    return 0;
+
+}
@@ -1,28 +1,738 @@
+// k-sum search with two pointers : pairs and triples adding up to a target.
+
+// Input : arr[] = {12, 15, 23, 45, 89, 93, 95, 189}, target = 140
+// Output : The left = 45 and the right = 95
+
+// On a sorted array, a left pointer moves up when the sum is too small and a
+// right pointer moves down when it is too big, O(n) per target.
+//  - Batched 2-sum : two_sum_batch() answers many targets in one pass.
+//    BATCH_WIDTH searches run side by side, one step each per round, and a
+//    finished search hands its slot to the next target. Each step is a
+//    branchless pair of pointer moves, and the searches do not depend on each
+//    other, so their loads overlap. Every search first narrows [left, right]
+//    to the values that can take part (binary searches for target - max and
+//    target - min).
+//  - 3-sum : three_sum() fixes the smallest value and runs a 2-sum on the
+//    rest. The outer loop is shared between threads in chunks taken from an
+//    atomic counter, since the early values have the longest inner loops.
+//  - Unsorted input : two_sum_unsorted() / three_sum_unsorted() count the
+//    distinct values in a hash table and look the last value up, O(d) per
+//    2-sum target and O(d^2) for a 3-sum, for d distinct values.
+// Every distinct tuple is reported once, its values in non-decreasing order,
+// through a callback ; collect_tuples() is a callback filling a buffer.
+// Sums are computed in long long, so no target overflows.
+
+// Time Complexity : O(n) per 2-sum target, O(n^2 / threads) for a 3-sum
+// Space Complexity : O(1) for 2-sum, O(tuples) with threads, O(n) hashed
+
+// Compile : gcc -O2 -pthread Two_Pointer_Technique.c -o two_pointer
+// Run     : ./two_pointer              (small example)
+//           ./two_pointer bench [logn] (one target at a time vs batched)
+
 #include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<limits.h>
+#include<time.h>
+#include<pthread.h>
+#include<unistd.h>
 
-int main(){
+// Number of 2-sum searches kept side by side
+#define BATCH_WIDTH 16
 
-    int arr[20] = {12, 15, 23, 45, 89, 93, 95, 189};
-    int i, j, n = 8, target = 140;
-    int left = 0, right = n - 1;
+// Outer 3-sum values handed to a thread at a time
+#define THREE_SUM_CHUNK 16
+
+#define MAX_THREADS 64
+
+// Values of one tuple (k of them, non-decreasing) found for targets[query]
+typedef void (*tuple_callback)(const int tuple[], int k, size_t query, void *ctx);
+
+struct ksum_tuple
+{
+    size_t query;
+    int values[3];
+};
+
+// Buffer for collect_tuples() : keeps the first `capacity` tuples, counts all
+struct tuple_buffer
+{
+    struct ksum_tuple *items;
+    size_t capacity;
+    size_t count;
+};
+
+void collect_tuples(const int tuple[], int k, size_t query, void *ctx)
+{
+    struct tuple_buffer *buffer = (struct tuple_buffer *)ctx;
 
-    while (left <= right) {
-        int currentSum = arr[left] + arr[right];
-        
-        if (currentSum == target)
+    if (buffer->count < buffer->capacity)
+    {
+        struct ksum_tuple *item = &buffer->items[buffer->count];
+
+        item->query = query;
+        memset(item->values, 0, sizeof(item->values));
+        memcpy(item->values, tuple, k * sizeof(int));
+    }
+    buffer->count++;
+}
+
+// First index with arr[i] >= key, key outside the int range allowed
+static size_t lower_bound_ll(const int arr[], size_t n, long long key)
+{
+    size_t low = 0, high = n;
+
+    while (low < high)
+    {
+        size_t mid = low + (high - low) / 2;
+
+        if (arr[mid] < key)
         {
-            printf("\n\nThe left = %d and the right = %d \n\n",arr[left], arr[right]);
-            break;
+            low = mid + 1;
         }
-        else if (currentSum < target)
+        else
         {
-            left++;
+            high = mid;
         }
-        else
+    }
+    return low;
+}
+
+// ------------------------------------------------------------------
+// 2-sum on a sorted array
+// ------------------------------------------------------------------
+
+// Searches in [left, right] for the pairs of arr[] summing to target. A match
+// moves both pointers ; `last` is the left value of the last pair, so the
+// copies of a value do not report it again.
+struct pair_search
+{
+    size_t left, right, query;
+    long long target;
+    int last, found;
+};
+
+// Sets up s for target ; returns 0 when no pair can exist
+static int start_search(struct pair_search *s, const int arr[], size_t n, long long target, size_t query)
+{
+    size_t left, right;
+
+    if (n < 2)
+    {
+        return 0;
+    }
+    left = lower_bound_ll(arr, n, target - arr[n - 1]);
+    right = lower_bound_ll(arr, n, target - arr[0] + 1);
+    if (right < 2 || left + 1 >= right)
+    {
+        return 0;
+    }
+    s->left = left;
+    s->right = right - 1;
+    s->query = query;
+    s->target = target;
+    s->found = 0;
+    return 1;
+}
+
+// One step ; returns 0 once the pointers have met
+static inline int step_search(struct pair_search *s, const int arr[], tuple_callback emit, void *ctx)
+{
+    int a = arr[s->left], b = arr[s->right];
+    long long sum = (long long)a + b;
+
+    if (sum == s->target && (!s->found || a != s->last))
+    {
+        int pair[2];
+
+        pair[0] = a;
+        pair[1] = b;
+        emit(pair, 2, s->query, ctx);
+        s->last = a;
+        s->found = 1;
+    }
+    s->left += (sum <= s->target);
+    s->right -= (sum >= s->target);
+    return s->left < s->right;
+}
+
+// Every pair of arr[] (sorted) adding up to targets[q], for every q. Pairs of
+// one target come in increasing order, but interleaved with other targets.
+void two_sum_batch(const int arr[], size_t n, const long long targets[], size_t count,
+                   tuple_callback emit, void *ctx)
+{
+    struct pair_search slots[BATCH_WIDTH];
+    size_t next = 0;
+    int used = 0, j;
+
+    // Fill the slots, then keep them busy until the targets run out
+    while (used < BATCH_WIDTH && next < count)
+    {
+        used += start_search(&slots[used], arr, n, targets[next], next);
+        next++;
+    }
+
+    while (used > 0)
+    {
+        for (j = 0; j < used; j++)
+        {
+            if (!step_search(&slots[j], arr, emit, ctx))
+            {
+                // Next target that has candidates, or the last slot
+                while (next < count && !start_search(&slots[j], arr, n, targets[next], next))
+                {
+                    next++;
+                }
+                if (next < count)
+                {
+                    next++;
+                }
+                else
+                {
+                    slots[j] = slots[--used];
+                    j--;
+                }
+            }
+        }
+    }
+}
+
+// Single target, for reference and small inputs
+void two_sum(const int arr[], size_t n, long long target, tuple_callback emit, void *ctx)
+{
+    struct pair_search s;
+
+    if (start_search(&s, arr, n, target, 0))
+    {
+        while (step_search(&s, arr, emit, ctx))
         {
-            right--;
         }
-                
     }
+}
+
+// ------------------------------------------------------------------
+// 3-sum on a sorted array
+// ------------------------------------------------------------------
+
+// Prepends the fixed smallest value to the pairs of the inner 2-sum
+struct triple_prefix
+{
+    int first;
+    tuple_callback emit;
+    void *ctx;
+};
+
+static void emit_triple(const int pair[], int k, size_t query, void *ctx)
+{
+    struct triple_prefix *prefix = (struct triple_prefix *)ctx;
+    int triple[3];
+
+    (void)k;
+    (void)query;
+    triple[0] = prefix->first;
+    triple[1] = pair[0];
+    triple[2] = pair[1];
+    prefix->emit(triple, 3, 0, prefix->ctx);
+}
+
+// Triples whose smallest value is arr[i] (first copy of that value only)
+static void triples_from(const int arr[], size_t n, size_t i, long long target, tuple_callback emit, void *ctx)
+{
+    struct triple_prefix prefix;
+    struct pair_search s;
+
+    if ((i > 0 && arr[i] == arr[i - 1]) || !start_search(&s, arr + i + 1, n - i - 1, target - arr[i], 0))
+    {
+        return;
+    }
+    prefix.first = arr[i];
+    prefix.emit = emit;
+    prefix.ctx = ctx;
+    while (step_search(&s, arr + i + 1, emit_triple, &prefix))
+    {
+    }
+}
+
+// Growable tuple list of one thread
+struct triple_list
+{
+    struct ksum_tuple *items;
+    size_t count, capacity;
+    int failed;
+};
+
+static void append_triple(const int tuple[], int k, size_t query, void *ctx)
+{
+    struct triple_list *list = (struct triple_list *)ctx;
+
+    (void)k;
+    (void)query;
+    if (list->count == list->capacity)
+    {
+        size_t capacity = list->capacity ? 2 * list->capacity : 256;
+        struct ksum_tuple *items = (struct ksum_tuple *)realloc(list->items, capacity * sizeof(struct ksum_tuple));
+
+        if (items == NULL)
+        {
+            list->failed = 1;
+            return;
+        }
+        list->items = items;
+        list->capacity = capacity;
+    }
+    list->items[list->count].query = 0;
+    memcpy(list->items[list->count].values, tuple, 3 * sizeof(int));
+    list->count++;
+}
+
+struct three_sum_job
+{
+    const int *arr;
+    size_t n;
+    long long target;
+    size_t *next;   // shared chunk counter
+    struct triple_list list;
+};
+
+static void *three_sum_worker(void *arg)
+{
+    struct three_sum_job *job = (struct three_sum_job *)arg;
+
+    for (;;)
+    {
+        size_t begin = __atomic_fetch_add(job->next, THREE_SUM_CHUNK, __ATOMIC_RELAXED);
+        size_t end = begin + THREE_SUM_CHUNK, i;
+
+        // Past n - 3 or past the point where 3 * arr[i] > target
+        if (begin + 2 >= job->n || 3LL * job->arr[begin] > job->target)
+        {
+            return NULL;
+        }
+        for (i = begin; i < end && i + 2 < job->n; i++)
+        {
+            triples_from(job->arr, job->n, i, job->target, append_triple, &job->list);
+        }
+    }
+}
+
+static int compare_triples(const void *a, const void *b)
+{
+    const int *x = ((const struct ksum_tuple *)a)->values;
+    const int *y = ((const struct ksum_tuple *)b)->values;
+
+    if (x[0] != y[0])
+    {
+        return (x[0] > y[0]) - (x[0] < y[0]);
+    }
+    return (x[1] > y[1]) - (x[1] < y[1]);
+}
+
+// Every triple of arr[] (sorted) adding up to target, in increasing order.
+// With threads > 1 the triples are gathered, sorted and then reported from
+// the calling thread. Returns 0, or -1 when memory runs out.
+int three_sum(const int arr[], size_t n, long long target, tuple_callback emit, void *ctx, int threads)
+{
+    struct three_sum_job jobs[MAX_THREADS];
+    pthread_t tid[MAX_THREADS];
+    int started[MAX_THREADS];
+    size_t next = 0, i, total = 0;
+    struct ksum_tuple *all;
+    int t, failed = 0;
+
+    if (threads > MAX_THREADS)
+    {
+        threads = MAX_THREADS;
+    }
+    if ((size_t)threads > n / (4 * THREE_SUM_CHUNK))
+    {
+        threads = (int)(n / (4 * THREE_SUM_CHUNK));
+    }
+    if (threads <= 1)
+    {
+        for (i = 0; i + 2 < n && 3LL * arr[i] <= target; i++)
+        {
+            triples_from(arr, n, i, target, emit, ctx);
+        }
+        return 0;
+    }
+
+    for (t = 0; t < threads; t++)
+    {
+        jobs[t].arr = arr;
+        jobs[t].n = n;
+        jobs[t].target = target;
+        jobs[t].next = &next;
+        memset(&jobs[t].list, 0, sizeof(jobs[t].list));
+        started[t] = (pthread_create(&tid[t], NULL, three_sum_worker, &jobs[t]) == 0);
+        if (!started[t])
+        {
+            three_sum_worker(&jobs[t]);
+        }
+    }
+    for (t = 0; t < threads; t++)
+    {
+        if (started[t])
+        {
+            pthread_join(tid[t], NULL);
+        }
+        total += jobs[t].list.count;
+        failed |= jobs[t].list.failed;
+    }
+
+    all = failed ? NULL : (struct ksum_tuple *)malloc((total ? total : 1) * sizeof(struct ksum_tuple));
+    if (all != NULL)
+    {
+        total = 0;
+        for (t = 0; t < threads; t++)
+        {
+            if (jobs[t].list.count > 0)
+            {
+                memcpy(all + total, jobs[t].list.items, jobs[t].list.count * sizeof(struct ksum_tuple));
+                total += jobs[t].list.count;
+            }
+        }
+        qsort(all, total, sizeof(struct ksum_tuple), compare_triples);
+        for (i = 0; i < total; i++)
+        {
+            emit(all[i].values, 3, 0, ctx);
+        }
+        free(all);
+    }
+    for (t = 0; t < threads; t++)
+    {
+        free(jobs[t].list.items);
+    }
+    return (all != NULL) ? 0 : -1;
+}
+
+// ------------------------------------------------------------------
+// Unsorted input : hash table of the distinct values
+// ------------------------------------------------------------------
+
+struct value_count
+{
+    int value;
+    size_t count;
+};
+
+// Open addressing, a slot stores an index into values[] + 1 (0 is empty)
+struct value_table
+{
+    size_t *slots;
+    size_t mask;
+    struct value_count *values;
+    size_t distinct;
+};
+
+static size_t hash_key(int key, size_t mask)
+{
+    return ((unsigned int)key * 2654435761u) & mask;
+}
+
+static void value_table_free(struct value_table *table)
+{
+    free(table->slots);
+    free(table->values);
+}
+
+// Returns 0, or -1 when memory runs out
+static int value_table_build(struct value_table *table, const int arr[], size_t n)
+{
+    size_t cap = 16, i;
+
+    while (cap < 2 * n)
+    {
+        cap *= 2;
+    }
+    table->mask = cap - 1;
+    table->distinct = 0;
+    table->slots = (size_t *)calloc(cap, sizeof(size_t));
+    table->values = (struct value_count *)malloc((n ? n : 1) * sizeof(struct value_count));
+    if (table->slots == NULL || table->values == NULL)
+    {
+        value_table_free(table);
+        return -1;
+    }
+
+    for (i = 0; i < n; i++)
+    {
+        size_t h = hash_key(arr[i], table->mask);
+
+        while (table->slots[h] != 0 && table->values[table->slots[h] - 1].value != arr[i])
+        {
+            h = (h + 1) & table->mask;
+        }
+        if (table->slots[h] == 0)
+        {
+            table->values[table->distinct].value = arr[i];
+            table->values[table->distinct].count = 0;
+            table->slots[h] = ++table->distinct;
+        }
+        table->values[table->slots[h] - 1].count++;
+    }
+    return 0;
+}
+
+// Copies of `key` in the array, 0 when absent or outside the int range
+static size_t value_table_count(const struct value_table *table, long long key)
+{
+    size_t h;
+
+    if (key < INT_MIN || key > INT_MAX)
+    {
+        return 0;
+    }
+    h = hash_key((int)key, table->mask);
+    while (table->slots[h] != 0)
+    {
+        const struct value_count *entry = &table->values[table->slots[h] - 1];
+
+        if (entry->value == key)
+        {
+            return entry->count;
+        }
+        h = (h + 1) & table->mask;
+    }
+    return 0;
+}
+
+// Same as two_sum_batch() for an unsorted array. Pairs come in no particular
+// order. Returns 0, or -1 when memory runs out.
+int two_sum_unsorted(const int arr[], size_t n, const long long targets[], size_t count,
+                     tuple_callback emit, void *ctx)
+{
+    struct value_table table;
+    size_t q, i;
+
+    if (value_table_build(&table, arr, n) != 0)
+    {
+        return -1;
+    }
+    for (q = 0; q < count; q++)
+    {
+        for (i = 0; i < table.distinct; i++)
+        {
+            int x = table.values[i].value;
+            long long y = targets[q] - x;
+            size_t copies;
+
+            if (y < x)
+            {
+                continue;
+            }
+            copies = value_table_count(&table, y);
+            if (copies >= 1 + (y == x))
+            {
+                int pair[2];
+
+                pair[0] = x;
+                pair[1] = (int)y;
+                emit(pair, 2, q, ctx);
+            }
+        }
+    }
+    value_table_free(&table);
+    return 0;
+}
+
+// Same as three_sum() for an unsorted array. Triples come in no particular
+// order. Returns 0, or -1 when memory runs out.
+int three_sum_unsorted(const int arr[], size_t n, long long target, tuple_callback emit, void *ctx)
+{
+    struct value_table table;
+    size_t i, j;
+
+    if (value_table_build(&table, arr, n) != 0)
+    {
+        return -1;
+    }
+    for (i = 0; i < table.distinct; i++)
+    {
+        const struct value_count *a = &table.values[i];
+
+        for (j = 0; j < table.distinct; j++)
+        {
+            const struct value_count *b = &table.values[j];
+            long long c = target - a->value - b->value;
+            size_t need = 1;
+
+            // a <= b <= c, each value used no more times than it occurs
+            if (b->value < a->value || c < b->value || (i == j && a->count < 2))
+            {
+                continue;
+            }
+            if (c == b->value)
+            {
+                need = (i == j) ? 3 : 2;
+            }
+            if (value_table_count(&table, c) >= need)
+            {
+                int triple[3];
+
+                triple[0] = a->value;
+                triple[1] = b->value;
+                triple[2] = (int)c;
+                emit(triple, 3, 0, ctx);
+            }
+        }
+    }
+    value_table_free(&table);
+    return 0;
+}
+
+// ------------------------------------------------------------------
+// Benchmark
+// ------------------------------------------------------------------
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static unsigned long long rng_state = 88172645463325252ULL;
+
+static unsigned long long next_random(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return rng_state;
+}
+
+static int compare_ints(const void *a, const void *b)
+{
+    int x = *(const int *)a, y = *(const int *)b;
+
+    return (x > y) - (x < y);
+}
+
+static void count_tuple(const int tuple[], int k, size_t query, void *ctx)
+{
+    (void)tuple;
+    (void)k;
+    (void)query;
+    (*(size_t *)ctx)++;
+}
+
+static void run_benchmark(int log_n)
+{
+    size_t n = (size_t)1 << log_n, queries = 4096, small = 4096, i;
+    int threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    int *arr = (int *)malloc(n * sizeof(int));
+    long long *targets = (long long *)malloc(queries * sizeof(long long));
+    size_t single = 0, batched = 0, hashed = 0, sorted3 = 0, hashed3 = 0;
+    double t0, t_single, t_batch, t_hash, t_three, t_three_hash;
+
+    if (arr == NULL || targets == NULL)
+    {
+        printf("Out of memory.\n");
+        free(arr);
+        free(targets);
+        return;
+    }
+
+    for (i = 0; i < n; i++)
+    {
+        arr[i] = (int)(next_random() % (4 * n));
+    }
+    for (i = 0; i < queries; i++)
+    {
+        targets[i] = (long long)(next_random() % (8 * n));
+    }
+
+    // Unsorted copy first for the hash path
+    t0 = now_seconds();
+    if (two_sum_unsorted(arr, n, targets, 64, count_tuple, &hashed) != 0)
+    {
+        printf("Out of memory.\n");
+    }
+    t_hash = (now_seconds() - t0) / 64;
+
+    qsort(arr, n, sizeof(int), compare_ints);
+
+    t0 = now_seconds();
+    for (i = 0; i < queries; i++)
+    {
+        two_sum(arr, n, targets[i], count_tuple, &single);
+    }
+    t_single = (now_seconds() - t0) / queries;
+
+    t0 = now_seconds();
+    two_sum_batch(arr, n, targets, queries, count_tuple, &batched);
+    t_batch = (now_seconds() - t0) / queries;
+
+    // 3-sum on the first `small` values, spread over the whole range
+    for (i = 0; i < small; i++)
+    {
+        arr[i] = (int)(next_random() % (64 * small)) - 32 * (int)small;
+    }
+    t0 = now_seconds();
+    three_sum_unsorted(arr, small, 0, count_tuple, &hashed3);
+    t_three_hash = now_seconds() - t0;
+    qsort(arr, small, sizeof(int), compare_ints);
+    t0 = now_seconds();
+    three_sum(arr, small, 0, count_tuple, &sorted3, threads);
+    t_three = now_seconds() - t0;
+
+    printf("n = %zu, %zu 2-sum targets, %d thread(s)\n", n, queries, threads);
+    printf("  one at a time : %8.2f us / target (%zu pairs)\n", t_single * 1e6, single);
+    printf("  batched       : %8.2f us / target (%zu pairs)\n", t_batch * 1e6, batched);
+    printf("  hashed        : %8.2f us / target\n", t_hash * 1e6);
+    printf("3-sum, n = %zu : sorted %.2f ms, hashed %.2f ms (%zu / %zu triples)\n",
+           small, t_three * 1e3, t_three_hash * 1e3, sorted3, hashed3);
+
+    free(arr);
+    free(targets);
+}
+
+static void print_pair(const int tuple[], int k, size_t query, void *ctx)
+{
+    (void)k;
+    (void)query;
+    (void)ctx;
+    printf("\n\nThe left = %d and the right = %d \n\n", tuple[0], tuple[1]);
+}
+
+int main(int argc, char *argv[])
+{
+    int arr[20] = {12, 15, 23, 45, 89, 93, 95, 189};
+    int triples[] = {-4, -1, -1, 0, 1, 2, 2};
+    long long targets[] = {140, 108, 300};
+    struct ksum_tuple items[16];
+    struct tuple_buffer buffer;
+    int n = 8;
+    long long target = 140;
+    size_t i;
+
+    if (argc > 1 && strcmp(argv[1], "bench") == 0)
+    {
+        run_benchmark(argc > 2 ? atoi(argv[2]) : 20);
+        return 0;
+    }
+
+    two_sum(arr, n, target, print_pair, NULL);
+
+    buffer.items = items;
+    buffer.capacity = 16;
+    buffer.count = 0;
+    two_sum_batch(arr, n, targets, 3, collect_tuples, &buffer);
+    printf("Pairs for 140, 108 and 300 :");
+    for (i = 0; i < buffer.count; i++)
+    {
+        printf(" %lld = %d + %d ;", targets[items[i].query], items[i].values[0], items[i].values[1]);
+    }
+
+    buffer.count = 0;
+    three_sum(triples, 7, 0, collect_tuples, &buffer, 1);
+    printf("\nTriples adding up to 0 :");
+    for (i = 0; i < buffer.count; i++)
+    {
+        printf(" (%d, %d, %d)", items[i].values[0], items[i].values[1], items[i].values[2]);
+    }
+    printf("\n");
+
     return 0;
-}
\ No newline at end of file
+}
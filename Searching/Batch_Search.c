@@ -0,0 +1,394 @@
+// Batched multi-key lookups against one array.
+
+// Instead of answering one target at a time, these functions take N query keys
+// and write N positions. Three strategies are provided :
+//  1. Interleaved binary search : BATCH_WIDTH searches run in lock-step. For a
+//     fixed n every search halves the same range length at every step, so the
+//     loads of all the searches in a group are independent and their cache
+//     misses overlap instead of being paid one after another.
+//  2. Sorted queries : when the keys are sorted the query stream is merged
+//     with the array. Each search starts at the previous answer and gallops
+//     forward, so the whole batch costs O(m log(n / m)) instead of O(m log n).
+//  3. Unsorted array : one linear pass over the array probes a small hash
+//     table of the query keys, O(n + m) instead of O(n * m).
+
+// Input : arr[] = { 1, 4, 6, 7, 23, 46, 68, 78, 98, 135, 156, 676}
+//         keys[] = { 135, 5, 676, 1, 78}
+// Output : 10 -1 12 1 8  (positions, -1 when the key is not present)
+
+// Time Complexity : O(m log n) interleaved, O(m log(n / m)) sorted queries,
+//                   O(n + m) linear
+// Space Complexity : O(1) extra for the sorted-array paths, O(m) for the linear pass
+
+// Compile : gcc -O2 Batch_Search.c -o batch_search
+// Run     : ./batch_search              (small example)
+//           ./batch_search bench [logn] (one-at-a-time vs batched)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Number of searches kept in flight. 16 is enough to cover DRAM latency with
+// the number of outstanding misses a core can track.
+#define BATCH_WIDTH 16
+
+#if defined(__GNUC__)
+#define PREFETCH(addr) __builtin_prefetch(addr)
+#else
+#define PREFETCH(addr) ((void)0)
+#endif
+
+// Single branchless lower_bound, used for the tail of a batch.
+static size_t lower_bound_one(const int arr[], size_t n, int target)
+{
+    const int *base = arr;
+    size_t len = n;
+
+    if (n == 0)
+    {
+        return 0;
+    }
+
+    while (len > 1)
+    {
+        size_t half = len / 2;
+
+        base += (base[half - 1] < target) ? half : 0;
+        len -= half;
+    }
+    return (size_t)(base - arr) + (*base < target);
+}
+
+// Interleaved lower_bound for every key. out[i] receives the index of the
+// first element >= keys[i], or n when there is none.
+void batch_lower_bound(const int arr[], size_t n, const int keys[], size_t count, size_t out[])
+{
+    size_t q = 0;
+
+    if (n == 0)
+    {
+        memset(out, 0, count * sizeof(size_t));
+        return;
+    }
+
+    for (; q + BATCH_WIDTH <= count; q += BATCH_WIDTH)
+    {
+        const int *base[BATCH_WIDTH];
+        size_t len = n;
+        int j;
+
+        for (j = 0; j < BATCH_WIDTH; j++)
+        {
+            base[j] = arr;
+        }
+
+        // All searches share len, so one step of every search is issued
+        // before any of them is waited on.
+        while (len > 1)
+        {
+            size_t half = len / 2;
+
+            for (j = 0; j < BATCH_WIDTH; j++)
+            {
+                base[j] += (base[j][half - 1] < keys[q + j]) ? half : 0;
+            }
+            len -= half;
+
+            // The next step reads base + len / 2 - 1 (fetched one step ago).
+            // The step after it reads one of two addresses, depending on
+            // whether the next step moves base by len / 2.
+            half = len / 2;
+            if ((len - half) / 2 > 0)
+            {
+                size_t quarter = (len - half) / 2;
+
+                for (j = 0; j < BATCH_WIDTH; j++)
+                {
+                    PREFETCH(base[j] + quarter - 1);
+                    PREFETCH(base[j] + half + quarter - 1);
+                }
+            }
+        }
+
+        for (j = 0; j < BATCH_WIDTH; j++)
+        {
+            out[q + j] = (size_t)(base[j] - arr) + (*base[j] < keys[q + j]);
+        }
+    }
+
+    for (; q < count; q++)
+    {
+        out[q] = lower_bound_one(arr, n, keys[q]);
+    }
+}
+
+// Batched binary search. out[i] receives the index of keys[i] in arr[],
+// or -1 when it is not present.
+void batch_binary_search(const int arr[], size_t n, const int keys[], size_t count, long out[])
+{
+    size_t chunk[256];
+    size_t q, j;
+
+    // Reuse a small stack buffer so no allocation is needed
+    for (q = 0; q < count; q += 256)
+    {
+        size_t m = (count - q < 256) ? count - q : 256;
+
+        batch_lower_bound(arr, n, keys + q, m, chunk);
+
+        for (j = 0; j < m; j++)
+        {
+            size_t pos = chunk[j];
+
+            out[q + j] = (pos < n && arr[pos] == keys[q + j]) ? (long)pos : -1;
+        }
+    }
+}
+
+// lower_bound for a sorted (non-decreasing) stream of keys, merging it with
+// the array. Every search starts at the previous answer and gallops forward
+// in steps 1, 2, 4 ... before finishing with a binary search in the last step.
+void batch_lower_bound_sorted(const int arr[], size_t n, const int keys[], size_t count, size_t out[])
+{
+    size_t pos = 0, q;
+
+    for (q = 0; q < count; q++)
+    {
+        int target = keys[q];
+        size_t lo = pos, step = 1, hi;
+
+        // Keys out of order : restart from the beginning for this one
+        if (q > 0 && target < keys[q - 1])
+        {
+            lo = 0;
+        }
+
+        // Gallop : find hi with arr[hi] >= target
+        hi = lo;
+        while (hi < n && arr[hi] < target)
+        {
+            lo = hi + 1;
+            hi += step;
+            step *= 2;
+        }
+        if (hi > n)
+        {
+            hi = n;
+        }
+
+        // Binary search in [lo, hi)
+        out[q] = lo + lower_bound_one(arr + lo, hi - lo, target);
+        pos = out[q];
+    }
+}
+
+// Hash table of query keys for the linear pass. Open addressing, the table
+// stores the query index + 1 so that 0 marks an empty slot.
+static size_t hash_key(int key, size_t mask)
+{
+    return ((unsigned int)key * 2654435761u) & mask;
+}
+
+// Batched linear search for unsorted arrays : one pass over arr[] answers
+// every key. out[i] receives the first index of keys[i], or -1.
+// Returns 0 on success, -1 when the hash table cannot be allocated.
+int batch_linear_search(const int arr[], size_t n, const int keys[], size_t count, long out[])
+{
+    size_t cap = 16, mask, i, remaining = 0;
+    size_t *table;
+
+    while (cap < 2 * count)
+    {
+        cap *= 2;
+    }
+    mask = cap - 1;
+
+    table = (size_t *)calloc(cap, sizeof(size_t));
+    if (table == NULL)
+    {
+        return -1;
+    }
+
+    // Duplicate keys share one slot ; their answer is copied at the end
+    for (i = 0; i < count; i++)
+    {
+        size_t h = hash_key(keys[i], mask);
+
+        out[i] = -1;
+        while (table[h] != 0 && keys[table[h] - 1] != keys[i])
+        {
+            h = (h + 1) & mask;
+        }
+        if (table[h] == 0)
+        {
+            table[h] = i + 1;
+            remaining++;
+        }
+    }
+
+    for (i = 0; i < n && remaining > 0; i++)
+    {
+        size_t h = hash_key(arr[i], mask);
+
+        while (table[h] != 0)
+        {
+            size_t idx = table[h] - 1;
+
+            if (keys[idx] == arr[i])
+            {
+                if (out[idx] == -1)
+                {
+                    out[idx] = (long)i;
+                    remaining--;
+                }
+                break;
+            }
+            h = (h + 1) & mask;
+        }
+    }
+
+    for (i = 0; i < count; i++)
+    {
+        size_t h = hash_key(keys[i], mask);
+
+        while (keys[table[h] - 1] != keys[i])
+        {
+            h = (h + 1) & mask;
+        }
+        out[i] = out[table[h] - 1];
+    }
+
+    free(table);
+    return 0;
+}
+
+// ------------------------------------------------------------------
+// Benchmark
+// ------------------------------------------------------------------
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static unsigned long long rng_state = 88172645463325252ULL;
+
+static unsigned long long next_random(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return rng_state;
+}
+
+static int compare_int(const void *a, const void *b)
+{
+    int x = *(const int *)a, y = *(const int *)b;
+
+    return (x > y) - (x < y);
+}
+
+static void run_benchmark(int log_n)
+{
+    size_t n = (size_t)1 << log_n, count = (size_t)1 << 22, i;
+    int *arr = (int *)malloc(n * sizeof(int));
+    int *keys = (int *)malloc(count * sizeof(int));
+    size_t *out = (size_t *)malloc(count * sizeof(size_t));
+    unsigned long long checksum = 0;
+    double t0, t_single, t_batch, t_sorted;
+
+    if (arr == NULL || keys == NULL || out == NULL)
+    {
+        printf("Out of memory.\n");
+        free(arr);
+        free(keys);
+        free(out);
+        return;
+    }
+
+    for (i = 0; i < n; i++)
+    {
+        arr[i] = (int)(2 * i);
+    }
+    for (i = 0; i < count; i++)
+    {
+        keys[i] = (int)(next_random() % (2 * n));
+    }
+
+    t0 = now_seconds();
+    for (i = 0; i < count; i++)
+    {
+        out[i] = lower_bound_one(arr, n, keys[i]);
+        checksum += out[i];
+    }
+    t_single = now_seconds() - t0;
+
+    t0 = now_seconds();
+    batch_lower_bound(arr, n, keys, count, out);
+    t_batch = now_seconds() - t0;
+    for (i = 0; i < count; i++)
+    {
+        checksum -= out[i];
+    }
+
+    // Sorting the keys is part of the cost of the merge path
+    t0 = now_seconds();
+    qsort(keys, count, sizeof(int), compare_int);
+    batch_lower_bound_sorted(arr, n, keys, count, out);
+    t_sorted = now_seconds() - t0;
+
+    printf("n = %zu, %zu queries\n", n, count);
+    printf("  one at a time     : %8.2f ns / key\n", t_single / count * 1e9);
+    printf("  interleaved batch : %8.2f ns / key\n", t_batch / count * 1e9);
+    printf("  sort + merge      : %8.2f ns / key\n", t_sorted / count * 1e9);
+    printf("  (checksum %llu)\n", checksum);
+
+    free(arr);
+    free(keys);
+    free(out);
+}
+
+int main(int argc, char *argv[])
+{
+    int arr[] = { 1, 4, 6, 7, 23, 46, 68, 78, 98, 135, 156, 676};
+    int keys[] = { 135, 5, 676, 1, 78};
+    int sorted_keys[] = { 1, 5, 78, 135, 676};
+    size_t n = sizeof(arr) / sizeof(arr[0]);
+    size_t count = sizeof(keys) / sizeof(keys[0]), i;
+    long found[5];
+    size_t bounds[5];
+
+    if (argc > 1 && strcmp(argv[1], "bench") == 0)
+    {
+        run_benchmark(argc > 2 ? atoi(argv[2]) : 24);
+        return 0;
+    }
+
+    batch_binary_search(arr, n, keys, count, found);
+    printf("\nBinary search positions : ");
+    for (i = 0; i < count; i++)
+    {
+        printf("%ld ", found[i] == -1 ? -1 : found[i] + 1);
+    }
+
+    batch_linear_search(arr, n, keys, count, found);
+    printf("\nLinear search positions : ");
+    for (i = 0; i < count; i++)
+    {
+        printf("%ld ", found[i] == -1 ? -1 : found[i] + 1);
+    }
+
+    batch_lower_bound_sorted(arr, n, sorted_keys, count, bounds);
+    printf("\nLower bounds of sorted keys : ");
+    for (i = 0; i < count; i++)
+    {
+        printf("%zu ", bounds[i]);
+    }
+    printf("\n");
+
+    return 0;
+}
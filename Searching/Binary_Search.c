@@ -1,12 +1,9 @@
-
 #include<stdio.h>
 
-int main()
+// Returns the index of target in the sorted arr[], or -1 when it is not present.
+int binary_search(int arr[], int size, int target)
 {
-    int arr[] = { 1, 4, 6, 7, 23, 46, 68, 78, 98, 135, 156, 676};
-    int mid, size = sizeof(arr) / sizeof(arr[0]);
-    int left = 0, right = size - 1, target = 135;
-    int flag = 0;
+    int mid, left = 0, right = size - 1;
 
     while (left <= right)
     {
@@ -14,9 +11,7 @@ int main()
 
         if (arr[mid] == target)
         {
-            flag = 1;
-            printf("\nThe element %d found at position %d.",arr[mid],mid+1);
-            break;
+            return mid;
         }
         
         else if (arr[mid] < target)
@@ -29,10 +24,27 @@ int main()
         }
 
     }
-    if ( flag == 0)
+    return -1;
+}
+
+// Search_Benchmark.c links this file with -DSEARCH_NO_MAIN
+#ifndef SEARCH_NO_MAIN
+int main()
+{
+    int arr[] = { 1, 4, 6, 7, 23, 46, 68, 78, 98, 135, 156, 676};
+    int mid, size = sizeof(arr) / sizeof(arr[0]);
+    int target = 135;
+
+    mid = binary_search(arr, size, target);
+    if ( mid != -1)
+    {
+        printf("\nThe element %d found at position %d.",arr[mid],mid+1);
+    }
+    else
     {
        printf("The element %d is not found in the array..",target);
     }
     
     return 0;
-}
\ No newline at end of file
+}
+#endif
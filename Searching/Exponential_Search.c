@@ -0,0 +1,208 @@
+// Exponential (galloping) search over unbounded and cursor-based sorted sources.
+
+// The other searches need the size n up front. Exponential search does not :
+// it probes positions 0, 1, 3, 7 ... (doubling the step) until it reaches a
+// key >= target or runs past the end of the data, and then binary searches
+// only the last step. Finding position p costs O(log p) probes, whatever the
+// total length is.
+// The data is read through a key_source callback, so it can be an array that
+// is still growing, a generated sequence, or any cursor over sorted keys whose
+// length is unknown. A key_source reports a missing position as past the end.
+// A gallop_cursor keeps the last position and every seek gallops forward from
+// there, so during a merge "next key >= x" costs O(log distance) instead of
+// O(log n).
+
+// Input : keys 3, 6, 9, 12 ... (3 * i, no end), target = 45
+// Output : The first key >= 45 is 45 at position 15.
+
+// Time Complexity : O(log p) where p is the distance to the answer
+// Space Complexity : O(1)
+
+// Compile : gcc -O2 Exponential_Search.c -o exponential
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+
+// Writes the key at position i into *key and returns 1, or returns 0 when
+// position i is past the current end of the source.
+typedef int (*key_source)(void *ctx, size_t i, int *key);
+
+// Position of the first key >= target in [lo, hi], where the caller knows the
+// answer is at most hi. Missing positions count as greater than any key.
+static size_t bounded_lower_bound(key_source src, void *ctx, size_t lo, size_t hi, int target)
+{
+    while (lo < hi)
+    {
+        size_t mid = lo + (hi - lo) / 2;
+        int key;
+
+        if (src(ctx, mid, &key) && key < target)
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+// Gallops from position start : returns the first position >= start whose
+// key is >= target, or the end of the source when there is none.
+size_t exponential_search_from(key_source src, void *ctx, size_t start, int target)
+{
+    size_t lo = start, step = 1, probe = start;
+    int key;
+
+    // Find a probe with key >= target (or past the end), doubling the step.
+    // Every probe that is still < target moves lo past it.
+    while (src(ctx, probe, &key) && key < target)
+    {
+        lo = probe + 1;
+        probe = lo + step - 1;
+        step *= 2;
+    }
+
+    return bounded_lower_bound(src, ctx, lo, probe, target);
+}
+
+// Position of the first key >= target in the whole source.
+size_t exponential_search(key_source src, void *ctx, int target)
+{
+    return exponential_search_from(src, ctx, 0, target);
+}
+
+// Cursor that remembers where the last seek stopped
+struct gallop_cursor
+{
+    key_source src;
+    void *ctx;
+    size_t pos;
+};
+
+void gallop_cursor_init(struct gallop_cursor *c, key_source src, void *ctx)
+{
+    c->src = src;
+    c->ctx = ctx;
+    c->pos = 0;
+}
+
+// Moves the cursor forward to the first key >= target, never backward.
+// Returns 1 and writes the key when there is one, 0 when the source is exhausted.
+int gallop_seek(struct gallop_cursor *c, int target, int *key)
+{
+    c->pos = exponential_search_from(c->src, c->ctx, c->pos, target);
+    return c->src(c->ctx, c->pos, key);
+}
+
+// Moves the cursor one position forward.
+int gallop_next(struct gallop_cursor *c, int *key)
+{
+    c->pos++;
+    return c->src(c->ctx, c->pos, key);
+}
+
+// ------------------------------------------------------------------
+// Example sources
+// ------------------------------------------------------------------
+
+// Plain array, the length only has to be known by the callback
+struct array_source
+{
+    const int *data;
+    size_t len;
+};
+
+static int array_key(void *ctx, size_t i, int *key)
+{
+    const struct array_source *a = (const struct array_source *)ctx;
+
+    if (i >= a->len)
+    {
+        return 0;
+    }
+    *key = a->data[i];
+    return 1;
+}
+
+// Exponential search on an array, index of target or -1
+long exponential_search_array(const int arr[], size_t n, int target)
+{
+    struct array_source a = { arr, n };
+    size_t pos = exponential_search(array_key, &a, target);
+
+    return (pos < n && arr[pos] == target) ? (long)pos : -1;
+}
+
+// Endless sequence of multiples of step
+static int multiples_key(void *ctx, size_t i, int *key)
+{
+    int step = *(const int *)ctx;
+
+    if (i >= (size_t)(INT_MAX / step))
+    {
+        return 0;
+    }
+    *key = (int)(i + 1) * step;
+    return 1;
+}
+
+int main()
+{
+    int step = 3, target = 45, key;
+    int log[16] = { 2, 5, 8, 13, 21, 34};
+    int other[] = { 1, 5, 6, 13, 14, 34, 40};
+    struct array_source growing = { log, 6 };
+    struct array_source second = { other, 7 };
+    struct gallop_cursor a, b;
+    size_t pos;
+    int ka, kb, has_a, has_b;
+
+    // Unbounded source : nobody knows where it ends
+    pos = exponential_search(multiples_key, &step, target);
+    multiples_key(&step, pos, &key);
+    printf("\nThe first key >= %d is %d at position %zu.", target, key, pos + 1);
+
+    // Growing log : search, append, resume from the same cursor
+    gallop_cursor_init(&a, array_key, &growing);
+    if (!gallop_seek(&a, 35, &key))
+    {
+        printf("\nNo key >= 35 yet (log has %zu keys).", growing.len);
+    }
+    log[6] = 40;
+    log[7] = 55;
+    growing.len = 8;
+    if (gallop_seek(&a, 35, &key))
+    {
+        printf("\nAfter the append, the first key >= 35 is %d at position %zu.", key, a.pos + 1);
+    }
+
+    // Merge : intersect two sorted sources by leapfrogging the cursors
+    printf("\nCommon keys : ");
+    gallop_cursor_init(&a, array_key, &growing);
+    gallop_cursor_init(&b, array_key, &second);
+    has_a = array_key(&growing, 0, &ka);
+    has_b = array_key(&second, 0, &kb);
+    while (has_a && has_b)
+    {
+        if (ka == kb)
+        {
+            printf("%d ", ka);
+            has_a = gallop_next(&a, &ka);
+            has_b = gallop_next(&b, &kb);
+        }
+        else if (ka < kb)
+        {
+            has_a = gallop_seek(&a, kb, &ka);
+        }
+        else
+        {
+            has_b = gallop_seek(&b, ka, &kb);
+        }
+    }
+    printf("\n");
+
+    return 0;
+}
@@ -0,0 +1,390 @@
+// Branchless binary search over an Eytzinger (BFS) layout.
+
+// The sorted array is rebuilt once into the order of a breadth-first walk of
+// the implicit binary search tree : the root lives at index 1 and the
+// children of node k live at 2k and 2k + 1. The first few levels of the tree
+// then share a handful of cache lines, and the 16 descendants four levels
+// below node k sit together in one 64-byte line, so they can be prefetched
+// while the current comparisons are still running.
+
+// Input : arr[] = { 1, 4, 6, 7, 23, 46, 68, 78, 98, 135, 156, 676}, target = 135
+// Output : The element 135 found at position 10.
+
+// Time Complexity : O(n) build, O(log n) per lookup
+// Space Complexity : O(n) for the Eytzinger copy
+
+// Compile : gcc -O2 Eytzinger_Search.c -o eytzinger
+// Run     : ./eytzinger              (small example)
+//           ./eytzinger bench [max]  (lookups per second, sizes 2^10 .. 2^max)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define CACHE_LINE 64
+
+// Number of ints in one cache line. Node k * EYTZ_BLOCK is the first of the
+// 16 descendants of node k four levels down.
+#define EYTZ_BLOCK (CACHE_LINE / sizeof(int))
+
+// Lookups the benchmark cross-checks between the three searches
+#define CHECK_QUERIES 4096
+
+#if defined(__GNUC__)
+#define PREFETCH(addr) __builtin_prefetch(addr)
+#else
+#define PREFETCH(addr) ((void)0)
+#endif
+
+// Returns the number of trailing one bits of k, i.e. how many levels we have
+// to climb back after the descent went right.
+static int trailing_ones(size_t k)
+{
+#if defined(__GNUC__)
+    return __builtin_ctzll(~(unsigned long long)k);
+#else
+    int count = 0;
+
+    while (k & 1)
+    {
+        k >>= 1;
+        count++;
+    }
+    return count;
+#endif
+}
+
+// Allocates a cache-line aligned buffer of n ints (rounded up to a whole line).
+static int *alloc_aligned_ints(size_t n)
+{
+    size_t bytes = (n * sizeof(int) + CACHE_LINE - 1) / CACHE_LINE * CACHE_LINE;
+
+    return (int *)aligned_alloc(CACHE_LINE, bytes);
+}
+
+// In-order walk of the implicit tree that copies sorted[] into eytz[].
+// Written with an explicit stack because the tree depth is only log2(n).
+static void eytzinger_fill(const int sorted[], int eytz[], size_t n)
+{
+    size_t stack[64];
+    size_t top = 0, i = 0, k = 1;
+
+    while (k <= n || top > 0)
+    {
+        // Go down the left spine first
+        while (k <= n)
+        {
+            stack[top++] = k;
+            k = 2 * k;
+        }
+
+        k = stack[--top];
+        eytz[k] = sorted[i++];
+        k = 2 * k + 1;
+    }
+}
+
+// One-time pass that rebuilds a sorted array into Eytzinger order.
+// Slot 0 is unused so that the children of k are 2k and 2k + 1. The returned
+// buffer holds n + 1 ints, is cache-line aligned and must be released with free().
+int *eytzinger_build(const int sorted[], size_t n)
+{
+    int *eytz = alloc_aligned_ints(n + 1);
+
+    if (eytz == NULL)
+    {
+        return NULL;
+    }
+
+    eytz[0] = 0;
+    eytzinger_fill(sorted, eytz, n);
+
+    return eytz;
+}
+
+// Branchless lower_bound over the Eytzinger layout.
+// Returns the slot k of the first key >= target, or 0 when every key is smaller.
+size_t eytzinger_lower_bound(const int eytz[], size_t n, int target)
+{
+    size_t k = 1;
+
+    while (k <= n)
+    {
+        // Fetch the line with the descendants four levels below, the loop
+        // reaches it after four more comparisons.
+        PREFETCH(eytz + k * EYTZ_BLOCK);
+        k = 2 * k + (eytz[k] < target);
+    }
+
+    // The answer is the last node where the descent went left : strip the
+    // trailing right turns and that left turn itself.
+    k >>= trailing_ones(k) + 1;
+
+    return k;
+}
+
+// Number of nodes in the subtree rooted at slot k of an n-node complete tree.
+static size_t subtree_size(size_t k, size_t n)
+{
+    size_t size = 0, first = k, width = 1;
+
+    while (first <= n)
+    {
+        size_t last = first + width - 1;
+
+        size += (last <= n ? last : n) - first + 1;
+        first *= 2;
+        width *= 2;
+    }
+    return size;
+}
+
+// Converts an Eytzinger slot back to its index in the sorted array.
+// Returns n for slot 0 (lower_bound past the end). O(log^2 n), so call it only
+// when the position is needed, not on every probe.
+size_t eytzinger_rank(size_t k, size_t n)
+{
+    size_t rank, depth = 0, node;
+    int level;
+
+    if (k == 0)
+    {
+        return n;
+    }
+
+    // Everything in the left subtree of k comes before k
+    rank = subtree_size(2 * k, n);
+
+    // Walk the path root -> k ; every right turn skips the parent and its left subtree
+    for (node = k; node > 1; node >>= 1)
+    {
+        depth++;
+    }
+
+    node = 1;
+    for (level = (int)depth - 1; level >= 0; level--)
+    {
+        size_t bit = (k >> level) & 1;
+
+        if (bit)
+        {
+            rank += subtree_size(2 * node, n) + 1;
+        }
+        node = 2 * node + bit;
+    }
+
+    return rank;
+}
+
+// Branchless lower_bound on the plain sorted array, for data that cannot be
+// rebuilt. Returns the index of the first key >= target, or n.
+size_t sorted_lower_bound(const int arr[], size_t n, int target)
+{
+    const int *base = arr;
+    size_t len = n;
+
+    if (n == 0)
+    {
+        return 0;
+    }
+
+    while (len > 1)
+    {
+        size_t half = len / 2;
+
+        PREFETCH(base + len / 4);
+        PREFETCH(base + half + len / 4);
+        base += (base[half - 1] < target) ? half : 0;
+        len -= half;
+    }
+
+    return (size_t)(base - arr) + (*base < target);
+}
+
+// The loop from Binary_Search.c, kept as the baseline for the benchmark.
+long binary_search(const int arr[], long size, int target)
+{
+    long left = 0, right = size - 1, mid;
+
+    while (left <= right)
+    {
+        mid = left + (right - left) / 2;
+
+        if (arr[mid] == target)
+        {
+            return mid;
+        }
+        else if (arr[mid] < target)
+        {
+            left = mid + 1;
+        }
+        else
+        {
+            right = mid - 1;
+        }
+    }
+    return -1;
+}
+
+// ------------------------------------------------------------------
+// Benchmark
+// ------------------------------------------------------------------
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// xorshift64 : fast enough that it does not show up in the timings
+static unsigned long long rng_state = 88172645463325252ULL;
+
+static unsigned long long next_random(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return rng_state;
+}
+
+static void run_benchmark(int max_log)
+{
+    const size_t queries = 1 << 22;
+    int *keys = (int *)malloc(queries * sizeof(int));
+    int log_n;
+
+    if (keys == NULL)
+    {
+        printf("Out of memory.\n");
+        return;
+    }
+
+    // Keys go up to 2n, which must stay an int
+    if (max_log > 29)
+    {
+        max_log = 29;
+    }
+
+    printf("%12s %14s %14s %14s   (million lookups / second)\n",
+           "n", "classic", "branchless", "eytzinger");
+
+    for (log_n = 10; log_n <= max_log; log_n += 2)
+    {
+        size_t n = (size_t)1 << log_n, i;
+        int *sorted = alloc_aligned_ints(n);
+        int *eytz;
+        double t0, t_classic, t_sorted, t_eytz;
+        unsigned long long checksum[3] = {0, 0, 0};
+        size_t mismatches = 0;
+
+        if (sorted == NULL)
+        {
+            printf("Out of memory at n = %zu.\n", n);
+            break;
+        }
+
+        // Even keys 0, 2, 4 ... so half of the random queries miss
+        for (i = 0; i < n; i++)
+        {
+            sorted[i] = (int)(2 * i);
+        }
+        for (i = 0; i < queries; i++)
+        {
+            keys[i] = (int)(next_random() % (2 * n));
+        }
+
+        eytz = eytzinger_build(sorted, n);
+        if (eytz == NULL)
+        {
+            printf("Out of memory at n = %zu.\n", n);
+            free(sorted);
+            break;
+        }
+
+        t0 = now_seconds();
+        for (i = 0; i < queries; i++)
+        {
+            checksum[0] += (unsigned long long)binary_search(sorted, (long)n, keys[i]);
+        }
+        t_classic = now_seconds() - t0;
+
+        t0 = now_seconds();
+        for (i = 0; i < queries; i++)
+        {
+            checksum[1] += sorted_lower_bound(sorted, n, keys[i]);
+        }
+        t_sorted = now_seconds() - t0;
+
+        t0 = now_seconds();
+        for (i = 0; i < queries; i++)
+        {
+            checksum[2] += eytzinger_lower_bound(eytz, n, keys[i]);
+        }
+        t_eytz = now_seconds() - t0;
+
+        // The checksums only keep the timed loops alive : the three functions
+        // answer in different terms. Cross-check a sample, untimed, with the
+        // Eytzinger slots turned back into sorted positions.
+        for (i = 0; i < CHECK_QUERIES && i < queries; i++)
+        {
+            size_t pos = sorted_lower_bound(sorted, n, keys[i]);
+            long hit = (pos < n && sorted[pos] == keys[i]) ? (long)pos : -1;
+
+            if (eytzinger_rank(eytzinger_lower_bound(eytz, n, keys[i]), n) != pos
+                || binary_search(sorted, (long)n, keys[i]) != hit)
+            {
+                mismatches++;
+            }
+        }
+
+        printf("%12zu %14.2f %14.2f %14.2f   (%s, checksum %llx)\n", n,
+               queries / t_classic / 1e6, queries / t_sorted / 1e6,
+               queries / t_eytz / 1e6, mismatches ? "MISMATCH" : "agree",
+               checksum[0] + checksum[1] + checksum[2]);
+
+        free(eytz);
+        free(sorted);
+    }
+
+    free(keys);
+}
+
+int main(int argc, char *argv[])
+{
+    int arr[] = { 1, 4, 6, 7, 23, 46, 68, 78, 98, 135, 156, 676};
+    size_t size = sizeof(arr) / sizeof(arr[0]);
+    int target = 135;
+    int *eytz;
+    size_t k, pos;
+
+    if (argc > 1 && strcmp(argv[1], "bench") == 0)
+    {
+        run_benchmark(argc > 2 ? atoi(argv[2]) : 26);
+        return 0;
+    }
+
+    eytz = eytzinger_build(arr, size);
+    if (eytz == NULL)
+    {
+        printf("Out of memory.\n");
+        return 1;
+    }
+
+    k = eytzinger_lower_bound(eytz, size, target);
+    pos = eytzinger_rank(k, size);
+
+    if (k != 0 && eytz[k] == target)
+    {
+        printf("\nThe element %d found at position %zu.\n", target, pos + 1);
+    }
+    else
+    {
+        printf("The element %d is not found in the array..\n", target);
+    }
+
+    free(eytz);
+    return 0;
+}
@@ -1,60 +1,270 @@
+// Interpolation search with a binary search guard (interpolation-binary hybrid).
 
-#include<stdio.h>
+// Every iteration first probes the interpolated position, which on
+// near-uniform keys lands next to the target and gives O(log log n). It then
+// also halves the remaining side with a binary step, so even on skewed data
+// the range at least halves per iteration and the worst case stays O(log n)
+// instead of degrading to a linear scan.
+// The interpolation is computed in 64-bit unsigned arithmetic : the key
+// distance fits in 32 bits, so the product cannot overflow as long as the
+// span (high - low) does too. Wider spans (more than 2^32 elements) probe
+// the middle instead until the range is small enough.
 
-int interpolation_search( int arr[], int n, int low, int high, int target)
+// Input : arr[] = { 2, 6, 45, 78, 89, 93, 97, 111, 123, 134, 155, 167, 189}, target = 123
+// Output : The element 123 is found at position 9.
+
+// Time Complexity : O(log log n) on uniform keys, O(log n) worst case
+// Space Complexity : O(1)
+
+// Compile : gcc -O2 Interpolation_Search.c -o interpolation -lm
+// Run     : ./interpolation              (small example)
+//           ./interpolation bench [logn] (against binary search)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <limits.h>
+#include <math.h>
+#include <time.h>
+
+// Returns the index of target in the sorted array arr[0 .. n), or -1.
+long interpolation_search(const int arr[], long n, int target)
 {
-   
-    while (low <= high && target <= arr[high] && target >= arr[low])
+    long low = 0, high = n - 1;
+
+    while (low <= high && target >= arr[low] && target <= arr[high])
     {
+        long prob_pos, mid;
+
+        // All keys in the range are equal
+        if (arr[high] == arr[low])
+        {
+            return (arr[low] == target) ? low : -1;
+        }
+
+        // Interpolation formula, overflow free, lands in [low, high]
+        if ((uint64_t)(high - low) <= UINT32_MAX)
+        {
+            prob_pos = low + (long)(((uint64_t)(high - low) * (uint64_t)((int64_t)target - arr[low]))
+                                   / (uint64_t)((int64_t)arr[high] - arr[low]));
+        }
+        else
+        {
+            prob_pos = low + (high - low) / 2;
+        }
+
+        if (arr[prob_pos] == target)
+        {
+            return prob_pos;
+        }
 
-        if ( low == high )
+        // Move the bound to the probe, then halve the side that is left
+        if (arr[prob_pos] < target)
         {
-            if ( arr[low] == target )
+            low = prob_pos + 1;
+            if (low > high)
             {
-                return low;
+                break;
             }
-            
-            return -1;
-        }
-        
-        //Interpolation formula
-        int prob_pos = low + (( high - low ) * ( target - arr[low] )) / ( arr[high] - arr[low]);
+            mid = low + (high - low) / 2;
 
-        // Ensure prob_pos is in array bound
-        if ( prob_pos < low || prob_pos > high)
+            if (target <= arr[mid])
+            {
+                high = mid;
+            }
+            else
+            {
+                low = mid + 1;
+            }
+        }
+        else
         {
-            return -1;
+            high = prob_pos - 1;
+            if (low > high)
+            {
+                break;
+            }
+            mid = low + (high - low) / 2;
+
+            if (target > arr[mid])
+            {
+                low = mid + 1;
+            }
+            else
+            {
+                high = mid;
+            }
         }
-        
-        //matched , increment, dicrement
-        if ( arr[prob_pos] == target)
+    }
+    return -1;
+}
+
+// The benchmark and main() are left out when Search_Benchmark.c links this file
+#ifndef SEARCH_NO_MAIN
+
+// ------------------------------------------------------------------
+// Benchmark
+// ------------------------------------------------------------------
+
+static long binary_search(const int arr[], long n, int target)
+{
+    long left = 0, right = n - 1, mid;
+
+    while (left <= right)
+    {
+        mid = left + (right - left) / 2;
+
+        if (arr[mid] == target)
         {
-           return prob_pos;
+            return mid;
         }
-        else if ( arr[prob_pos] < target)
+        else if (arr[mid] < target)
         {
-            low++;
+            left = mid + 1;
         }
         else
         {
-            high--;
+            right = mid - 1;
         }
-        
     }
     return -1;
 }
 
-int main()
+static double now_seconds(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static unsigned long long rng_state = 88172645463325252ULL;
+
+static unsigned long long next_random(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return rng_state;
+}
+
+// Uniform double in [0, 1)
+static double next_unit(void)
+{
+    return (next_random() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static int compare_int(const void *a, const void *b)
+{
+    int x = *(const int *)a, y = *(const int *)b;
+
+    return (x > y) - (x < y);
+}
+
+// Fills arr[] with n sorted keys.
+//   0 : uniform over [0, INT_MAX]
+//   1 : Zipf-like, Pareto(alpha = 1) samples, most keys small and a long tail
+//   2 : clustered, 64 tight clusters spread over the whole key space
+static void generate_keys(int arr[], long n, int kind)
+{
+    long i;
+
+    for (i = 0; i < n; i++)
+    {
+        double x;
+
+        if (kind == 0)
+        {
+            x = next_unit() * INT_MAX;
+        }
+        else if (kind == 1)
+        {
+            x = 1.0 / (1.0 - next_unit()) - 1.0;
+            x = (x > INT_MAX) ? INT_MAX : x;
+        }
+        else
+        {
+            double center = (double)(next_random() % 64) / 64.0 * INT_MAX;
+
+            x = center + next_unit() * 4096.0;
+            x = (x > INT_MAX) ? INT_MAX : x;
+        }
+        arr[i] = (int)x;
+    }
+    qsort(arr, n, sizeof(int), compare_int);
+}
+
+static void run_benchmark(int log_n)
+{
+    const char *names[] = { "uniform", "zipf", "clustered" };
+    long n = 1L << log_n, queries = 1L << 21, i;
+    int *arr = (int *)malloc(n * sizeof(int));
+    int *keys = (int *)malloc(queries * sizeof(int));
+    int kind;
+
+    if (arr == NULL || keys == NULL)
+    {
+        printf("Out of memory.\n");
+        free(arr);
+        free(keys);
+        return;
+    }
+
+    printf("n = %ld, %ld queries (half hits, half random)\n", n, queries);
+    printf("%12s %16s %16s\n", "data", "binary ns/op", "interp ns/op");
+
+    for (kind = 0; kind < 3; kind++)
+    {
+        long hits[2] = {0, 0};
+        double t0, t_binary, t_interp;
+
+        generate_keys(arr, n, kind);
+        for (i = 0; i < queries; i++)
+        {
+            keys[i] = (i & 1) ? arr[next_random() % n] : (int)(next_random() & INT_MAX);
+        }
+
+        t0 = now_seconds();
+        for (i = 0; i < queries; i++)
+        {
+            hits[0] += binary_search(arr, n, keys[i]) >= 0;
+        }
+        t_binary = now_seconds() - t0;
+
+        t0 = now_seconds();
+        for (i = 0; i < queries; i++)
+        {
+            hits[1] += interpolation_search(arr, n, keys[i]) >= 0;
+        }
+        t_interp = now_seconds() - t0;
+
+        printf("%12s %16.1f %16.1f   (hits %ld / %ld)\n", names[kind],
+               t_binary / queries * 1e9, t_interp / queries * 1e9, hits[0], hits[1]);
+    }
+
+    free(arr);
+    free(keys);
+}
+
+int main(int argc, char *argv[])
 {
     int arr[] = { 2, 6, 45, 78, 89, 93, 97, 111, 123, 134, 155, 167, 189};
-    int n = sizeof(arr)/sizeof(arr[0]);
-    int low = 0, high = n - 1, target = 123;
+    long n = sizeof(arr)/sizeof(arr[0]);
+    int target = 123;
+    long result;
+
+    if (argc > 1 && strcmp(argv[1], "bench") == 0)
+    {
+        run_benchmark(argc > 2 ? atoi(argv[2]) : 24);
+        return 0;
+    }
 
-    int result = interpolation_search( arr, n, low, high, target );
+    result = interpolation_search( arr, n, target );
 
-    if (result != 0)
+    if (result != -1)
     {
-        printf("\nThe element %d is found at position %d.", target, result + 1 );
+        printf("\nThe element %d is found at position %ld.", target, result + 1 );
     }
     else
     {
@@ -62,4 +272,5 @@ int main()
     }
 
     return 0;
-}
\ No newline at end of file
+}
+#endif
@@ -11,13 +11,14 @@ int min(int a, int b)
 int jump_search(int arr[], int n, int target)
 {
 
-    int jump = (int)sqrt(n);//Mesure how many element will skip based on array size
+    int step = (int)sqrt(n);//Mesure how many element will skip based on array size
+    int jump = step;
     int prev = 0;
 
     while (arr[min(jump, n) - 1] < target)
     {
         prev = jump;
-        jump += (int)sqrt(n);
+        jump += step;
 
         if (prev >= n)
         {
@@ -39,9 +40,12 @@ int jump_search(int arr[], int n, int target)
     return -1;  
 }
 
+// For large sorted arrays see Static_Search_Tree.c, which needs about
+// log_17(n) cache lines per lookup instead of sqrt(n).
 
 
-// Example usage
+// Example usage, Search_Benchmark.c links this file with -DSEARCH_NO_MAIN
+#ifndef SEARCH_NO_MAIN
 int main()
 {
     int arr[] = {1, 3, 5, 7, 9, 11, 13, 15, 17, 19};
@@ -60,3 +64,4 @@ int main()
 
     return 0;
 }
+#endif
@@ -0,0 +1,519 @@
+// Learned index : error-bounded piecewise-linear model over a sorted int array
+// (in the style of the PGM index).
+
+// Keys such as timestamps and IDs are almost a linear function of their
+// position. The model cuts the keys into segments and stores for each one a
+// line  pos = intercept + slope * (key - first_key)  that predicts the
+// position of every key of the segment within +-epsilon. A lookup predicts a
+// position and finishes with a binary search over only 2 * epsilon + 3 slots.
+//  - Segments are fitted in one pass with a shrinking cone : the set of slopes
+//    that keeps every point of the segment within epsilon only shrinks, and a
+//    new segment starts when it becomes empty.
+//  - When there are many segments, the first keys of the segments are
+//    themselves indexed the same way, level over level, up to a single root
+//    segment, so finding the segment is also a bounded search.
+//  - Keys appended to the end of the array extend the last segment (the cone
+//    state is kept), and only the small upper levels are rebuilt.
+// With epsilon = 64 every segment covers at least ~128 keys, and near-linear
+// data needs only a handful of segments, so the model is far below 1% of the
+// data size.
+
+// Input : arr[] = { 1000, 2003, 2998, 4001, 5000, 6010, 6990, 8002, 9000, 10001}, target = 6990
+// Output : The element 6990 found at position 7.
+
+// Time Complexity : O(n) build, O(log epsilon) per level per lookup
+// Space Complexity : O(number of segments)
+
+// Compile : gcc -O2 Learned_Index.c -o learned_index
+// Run     : ./learned_index              (small example)
+//           ./learned_index bench [logn] (against binary search)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <math.h>
+#include <time.h>
+
+#define PGM_MAX_LEVELS 16
+
+// Error bound of the levels above the data
+#define PGM_INTERNAL_EPSILON 4
+
+// One level of the model : the segments, stored as parallel arrays so that
+// the first keys form a plain sorted array that can be searched directly.
+struct pgm_level
+{
+    int *keys;          // first key of every segment
+    double *intercept;  // position of that key
+    double *slope;
+    size_t count, cap;
+};
+
+// Shrinking cone of the segment that is still open
+struct pgm_cone
+{
+    double x0, y0;      // first point of the segment
+    double lo, hi;      // slopes that keep all points within epsilon
+};
+
+struct pgm_index
+{
+    size_t n;                               // keys indexed so far
+    size_t epsilon;
+    int height;                             // levels in use, 0 = data segments
+    struct pgm_level levels[PGM_MAX_LEVELS];
+    struct pgm_cone cone;                   // open segment of level 0
+    int last_key;                           // to skip duplicates on append
+};
+
+static int level_push(struct pgm_level *lv, int key, double pos)
+{
+    if (lv->count == lv->cap)
+    {
+        size_t cap = lv->cap ? 2 * lv->cap : 16;
+        int *keys = (int *)realloc(lv->keys, cap * sizeof(int));
+        double *intercept, *slope;
+
+        if (keys == NULL)
+        {
+            return -1;
+        }
+        lv->keys = keys;
+
+        intercept = (double *)realloc(lv->intercept, cap * sizeof(double));
+        if (intercept == NULL)
+        {
+            return -1;
+        }
+        lv->intercept = intercept;
+
+        slope = (double *)realloc(lv->slope, cap * sizeof(double));
+        if (slope == NULL)
+        {
+            return -1;
+        }
+        lv->slope = slope;
+        lv->cap = cap;
+    }
+
+    lv->keys[lv->count] = key;
+    lv->intercept[lv->count] = pos;
+    lv->slope[lv->count] = 0.0;
+    lv->count++;
+    return 0;
+}
+
+static void level_free(struct pgm_level *lv)
+{
+    free(lv->keys);
+    free(lv->intercept);
+    free(lv->slope);
+    memset(lv, 0, sizeof(*lv));
+}
+
+// Adds the point (key, pos) to the open segment of lv, or starts a new
+// segment when no slope fits it. Keys must be strictly increasing.
+static int fit_point(struct pgm_level *lv, struct pgm_cone *c, int key, double pos, double eps)
+{
+    if (lv->count > 0)
+    {
+        double dx = (double)key - c->x0;
+        double lo = (pos - c->y0 - eps) / dx;
+        double hi = (pos - c->y0 + eps) / dx;
+
+        lo = (lo > c->lo) ? lo : c->lo;
+        hi = (hi < c->hi) ? hi : c->hi;
+
+        if (lo <= hi)
+        {
+            c->lo = lo;
+            c->hi = hi;
+            lv->slope[lv->count - 1] = (lo + hi) / 2;
+            return 0;
+        }
+    }
+
+    c->x0 = key;
+    c->y0 = pos;
+    c->lo = 0.0;
+    c->hi = HUGE_VAL;
+    return level_push(lv, key, pos);
+}
+
+// Predicted position of key in the level below, clamped to [0, limit]
+static double predict(const struct pgm_level *lv, size_t seg, int key, size_t limit)
+{
+    double pos = lv->intercept[seg] + lv->slope[seg] * ((double)key - lv->keys[seg]);
+
+    if (pos < 0)
+    {
+        return 0;
+    }
+    return (pos > (double)limit) ? (double)limit : pos;
+}
+
+// First index i in a[0 .. n) with a[i] > target (upper = 1) or a[i] >= target
+// (upper = 0), searching around pred. The window is widened by galloping when
+// the answer is outside of it, so a wrong prediction only costs time.
+static size_t bounded_search(const int a[], size_t n, int target, double pred, size_t eps, int upper)
+{
+    size_t p = (size_t)pred, step = eps + 1;
+    size_t lo = (p > eps + 1) ? p - eps - 1 : 0;
+    size_t hi = (p + eps + 2 < n) ? p + eps + 2 : n;
+
+#define BEFORE(x) (upper ? (x) <= target : (x) < target)
+
+    while (lo > 0 && !BEFORE(a[lo - 1]))
+    {
+        lo = (lo > step) ? lo - step : 0;
+        step *= 2;
+    }
+    while (hi < n && BEFORE(a[hi]))
+    {
+        hi = (hi + step < n) ? hi + step : n;
+        step *= 2;
+    }
+
+    while (lo < hi)
+    {
+        size_t mid = lo + (hi - lo) / 2;
+
+        if (BEFORE(a[mid]))
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+
+#undef BEFORE
+    return lo;
+}
+
+// Rebuilds every level above level 0
+static int build_upper_levels(struct pgm_index *idx)
+{
+    int h;
+
+    for (h = 1; h < PGM_MAX_LEVELS; h++)
+    {
+        level_free(&idx->levels[h]);
+    }
+
+    idx->height = 1;
+    while (idx->levels[idx->height - 1].count > 1 && idx->height < PGM_MAX_LEVELS)
+    {
+        const struct pgm_level *below = &idx->levels[idx->height - 1];
+        struct pgm_level *lv = &idx->levels[idx->height];
+        struct pgm_cone cone;
+        size_t i;
+
+        for (i = 0; i < below->count; i++)
+        {
+            if (fit_point(lv, &cone, below->keys[i], (double)i, PGM_INTERNAL_EPSILON) != 0)
+            {
+                return -1;
+            }
+        }
+        idx->height++;
+    }
+    return 0;
+}
+
+// Feeds arr[from .. n) into level 0, skipping duplicate keys so that every
+// point is the first occurrence of its key.
+static int fit_data(struct pgm_index *idx, const int arr[], size_t from, size_t n)
+{
+    size_t i;
+
+    for (i = from; i < n; i++)
+    {
+        if (i > 0 && idx->levels[0].count > 0 && arr[i] == idx->last_key)
+        {
+            continue;
+        }
+        if (fit_point(&idx->levels[0], &idx->cone, arr[i], (double)i, (double)idx->epsilon) != 0)
+        {
+            return -1;
+        }
+        idx->last_key = arr[i];
+    }
+    idx->n = n;
+    return 0;
+}
+
+void pgm_free(struct pgm_index *idx)
+{
+    int h;
+
+    for (h = 0; h < PGM_MAX_LEVELS; h++)
+    {
+        level_free(&idx->levels[h]);
+    }
+    idx->height = 0;
+    idx->n = 0;
+}
+
+// Builds the model over the sorted array arr[0 .. n).
+// Returns 0 on success, -1 when out of memory.
+int pgm_build(struct pgm_index *idx, const int arr[], size_t n, size_t epsilon)
+{
+    memset(idx, 0, sizeof(*idx));
+    idx->epsilon = epsilon;
+
+    if (fit_data(idx, arr, 0, n) != 0 || build_upper_levels(idx) != 0)
+    {
+        pgm_free(idx);
+        return -1;
+    }
+    return 0;
+}
+
+// Incremental rebuild after keys were appended : arr[0 .. old n) is unchanged
+// and arr[old n .. new_n) holds keys >= the previous last key.
+int pgm_append(struct pgm_index *idx, const int arr[], size_t new_n)
+{
+    if (fit_data(idx, arr, idx->n, new_n) != 0)
+    {
+        return -1;
+    }
+    return build_upper_levels(idx);
+}
+
+// Index of the first key >= target, or n.
+size_t pgm_lower_bound(const struct pgm_index *idx, const int arr[], int target)
+{
+    size_t seg = 0;
+    int h;
+
+    if (idx->n == 0)
+    {
+        return 0;
+    }
+
+    // Walk down the segment levels, each one points into the level below
+    for (h = idx->height - 1; h >= 1; h--)
+    {
+        const struct pgm_level *below = &idx->levels[h - 1];
+        double pred = predict(&idx->levels[h], seg, target, below->count - 1);
+        size_t next = bounded_search(below->keys, below->count, target, pred, PGM_INTERNAL_EPSILON, 1);
+
+        seg = (next > 0) ? next - 1 : 0;
+    }
+
+    return bounded_search(arr, idx->n, target,
+                          predict(&idx->levels[0], seg, target, idx->n - 1), idx->epsilon, 0);
+}
+
+// Index of target in arr[], or -1.
+long pgm_search(const struct pgm_index *idx, const int arr[], int target)
+{
+    size_t pos = pgm_lower_bound(idx, arr, target);
+
+    return (pos < idx->n && arr[pos] == target) ? (long)pos : -1;
+}
+
+// Range lookup : positions [*first, *last) of the keys in [lo, hi].
+void pgm_range(const struct pgm_index *idx, const int arr[], int lo, int hi, size_t *first, size_t *last)
+{
+    *first = pgm_lower_bound(idx, arr, lo);
+    *last = *first;
+
+    if (hi < lo)
+    {
+        return;
+    }
+
+    // Keys greater than hi start at upper_bound(hi) = lower_bound(hi + 1)
+    if (hi == INT_MAX)
+    {
+        *last = idx->n;
+    }
+    else
+    {
+        *last = pgm_lower_bound(idx, arr, hi + 1);
+    }
+}
+
+// Bytes used by the model
+size_t pgm_size_bytes(const struct pgm_index *idx)
+{
+    size_t bytes = sizeof(*idx);
+    int h;
+
+    for (h = 0; h < idx->height; h++)
+    {
+        bytes += idx->levels[h].count * (sizeof(int) + 2 * sizeof(double));
+    }
+    return bytes;
+}
+
+// ------------------------------------------------------------------
+// Benchmark
+// ------------------------------------------------------------------
+
+static long binary_search(const int arr[], long n, int target)
+{
+    long left = 0, right = n - 1, mid;
+
+    while (left <= right)
+    {
+        mid = left + (right - left) / 2;
+
+        if (arr[mid] == target)
+        {
+            return mid;
+        }
+        else if (arr[mid] < target)
+        {
+            left = mid + 1;
+        }
+        else
+        {
+            right = mid - 1;
+        }
+    }
+    return -1;
+}
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static unsigned long long rng_state = 88172645463325252ULL;
+
+static unsigned long long next_random(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return rng_state;
+}
+
+static void run_benchmark(int log_n)
+{
+    long n, queries = 1L << 21, i;
+    int *arr, *keys;
+    struct pgm_index idx;
+    long found[2] = {0, 0};
+    double t0, t_build, t_binary, t_pgm;
+    int h;
+
+    // Keys grow by at most 83 per element and must stay an int
+    if (log_n > 24)
+    {
+        log_n = 24;
+    }
+    n = 1L << log_n;
+    arr = (int *)malloc(n * sizeof(int));
+    keys = (int *)malloc(queries * sizeof(int));
+    if (arr == NULL || keys == NULL)
+    {
+        printf("Out of memory.\n");
+        free(arr);
+        free(keys);
+        return;
+    }
+
+    // Timestamp-like keys : a steady rate with jitter and occasional bursts
+    arr[0] = 0;
+    for (i = 1; i < n; i++)
+    {
+        unsigned long long r = next_random();
+
+        arr[i] = arr[i - 1] + ((r & 1023) == 0 ? 1 : 20 + (int)(r >> 58));
+    }
+    for (i = 0; i < queries; i++)
+    {
+        keys[i] = (i & 1) ? arr[next_random() % n] : (int)(next_random() % (unsigned)arr[n - 1]);
+    }
+
+    t0 = now_seconds();
+    if (pgm_build(&idx, arr, n, 64) != 0)
+    {
+        printf("Out of memory.\n");
+        free(arr);
+        free(keys);
+        return;
+    }
+    t_build = now_seconds() - t0;
+
+    t0 = now_seconds();
+    for (i = 0; i < queries; i++)
+    {
+        found[0] += binary_search(arr, n, keys[i]) >= 0;
+    }
+    t_binary = now_seconds() - t0;
+
+    t0 = now_seconds();
+    for (i = 0; i < queries; i++)
+    {
+        found[1] += pgm_search(&idx, arr, keys[i]) >= 0;
+    }
+    t_pgm = now_seconds() - t0;
+
+    printf("n = %ld, epsilon = %zu, build %.1f ms\n", n, idx.epsilon, t_build * 1e3);
+    for (h = 0; h < idx.height; h++)
+    {
+        printf("  level %d : %zu segments\n", h, idx.levels[h].count);
+    }
+    printf("  model size    : %zu bytes (%.4f%% of the data)\n", pgm_size_bytes(&idx),
+           100.0 * pgm_size_bytes(&idx) / (n * sizeof(int)));
+    printf("  binary search : %8.1f ns / lookup (%ld found)\n", t_binary / queries * 1e9, found[0]);
+    printf("  learned index : %8.1f ns / lookup (%ld found)\n", t_pgm / queries * 1e9, found[1]);
+
+    pgm_free(&idx);
+    free(arr);
+    free(keys);
+}
+
+int main(int argc, char *argv[])
+{
+    int arr[16] = { 1000, 2003, 2998, 4001, 5000, 6010, 6990, 8002, 9000, 10001};
+    size_t n = 10, first, last;
+    int target = 6990;
+    struct pgm_index idx;
+    long result;
+
+    if (argc > 1 && strcmp(argv[1], "bench") == 0)
+    {
+        run_benchmark(argc > 2 ? atoi(argv[2]) : 24);
+        return 0;
+    }
+
+    if (pgm_build(&idx, arr, n, 2) != 0)
+    {
+        printf("Out of memory.\n");
+        return 1;
+    }
+
+    result = pgm_search(&idx, arr, target);
+    if (result != -1)
+    {
+        printf("\nThe element %d found at position %ld.", target, result + 1);
+    }
+    else
+    {
+        printf("\nThe element %d is not found in the array.", target);
+    }
+
+    // Append new keys and extend the model
+    arr[10] = 11003;
+    arr[11] = 11998;
+    arr[12] = 13004;
+    pgm_append(&idx, arr, 13);
+
+    pgm_range(&idx, arr, 5000, 12000, &first, &last);
+    printf("\nKeys in [5000, 12000] : positions %zu to %zu, %zu segment(s)\n",
+           first + 1, last, idx.levels[0].count);
+
+    pgm_free(&idx);
+    return 0;
+}
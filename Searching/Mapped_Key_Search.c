@@ -0,0 +1,556 @@
+// Searching sorted key files through mmap, without loading them into RAM.
+
+// A key file is a small header followed by the keys (4 or 8 bytes each, in
+// native byte order) and an optional sparse index :
+//
+//   offset 0          header (64 bytes, see struct keyfile_header)
+//   keys_offset       count keys, page aligned
+//   index_offset      every index_stride-th key, one entry per page of keys
+//
+// The keys are stored either sorted or in Eytzinger (BFS) order.
+// The file is mapped read-only and searched in place. Only the pages touched
+// by a lookup are read from disk :
+//  - Sorted layout : the sparse index is copied into RAM when the file is
+//    opened (it is ~0.2% of the file). A lookup binary searches it in memory
+//    and then the one page of keys it points to, so a cold lookup costs one
+//    or two page faults. Files written without an index get one sampled in
+//    memory instead (at most SAMPLE_LIMIT keys).
+//  - Eytzinger layout : the top levels of the tree are the first keys of the
+//    file, they are copied into RAM and the remaining levels are read from
+//    the mapping, one page fault per level below the copy.
+// madvise(MADV_RANDOM) turns off read-ahead on the keys, since random lookups
+// would waste it, and MADV_WILLNEED pre-reads the index region.
+// Needs a POSIX system (mmap).
+
+// Time Complexity : O(log n) per lookup, O(log(n / stride)) of it in RAM
+// Space Complexity : O(n / stride) in RAM
+
+// Compile : gcc -O2 Mapped_Key_Search.c -o mapped_search
+// Run     : ./mapped_search                          (demo on a temporary file)
+//           ./mapped_search write <file> <n> [eytz]  (write n sorted 64-bit keys)
+//           ./mapped_search find <file> <key> ...    (look keys up)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/resource.h>
+
+#define KEYFILE_MAGIC "DSAKEYS1"
+#define KEYFILE_SORTED 0
+#define KEYFILE_EYTZINGER 1
+
+// Largest in-memory sample when the file has no sparse index
+#define SAMPLE_LIMIT 65536
+
+// Eytzinger slots kept in RAM : the first 16 levels
+#define EYTZ_TOP_SLOTS 65535
+
+struct keyfile_header
+{
+    char magic[8];          // KEYFILE_MAGIC
+    uint64_t count;         // number of keys
+    uint32_t key_width;     // 4 or 8 bytes
+    uint32_t layout;        // KEYFILE_SORTED or KEYFILE_EYTZINGER
+    uint64_t keys_offset;   // page aligned
+    uint64_t index_offset;  // 0 when there is no sparse index
+    uint64_t index_stride;  // keys between two index entries
+    uint64_t index_count;
+    uint64_t reserved;
+};
+
+struct keyfile
+{
+    const unsigned char *map;   // whole file
+    size_t map_bytes;
+    const unsigned char *keys;  // first key
+    uint64_t count;
+    uint32_t key_width;
+    uint32_t layout;
+    uint64_t *top;              // in-memory index / top levels
+    uint64_t top_count;
+    uint64_t stride;            // sorted layout : keys per top entry
+};
+
+static uint64_t key_at(const struct keyfile *kf, uint64_t i)
+{
+    if (kf->key_width == 8)
+    {
+        return ((const uint64_t *)kf->keys)[i];
+    }
+    return ((const uint32_t *)kf->keys)[i];
+}
+
+// ------------------------------------------------------------------
+// Writer
+// ------------------------------------------------------------------
+
+static void write_key(unsigned char *dst, uint64_t key, uint32_t width)
+{
+    if (width == 8)
+    {
+        memcpy(dst, &key, 8);
+    }
+    else
+    {
+        uint32_t k = (uint32_t)key;
+
+        memcpy(dst, &k, 4);
+    }
+}
+
+// In-order walk of the implicit tree : slot k (1-based) of the output gets
+// the next sorted key. Output slot k is stored at file position k - 1.
+static void eytzinger_fill(const uint64_t sorted[], uint64_t eytz[], uint64_t n)
+{
+    uint64_t stack[64];
+    uint64_t top = 0, i = 0, k = 1;
+
+    while (k <= n || top > 0)
+    {
+        while (k <= n)
+        {
+            stack[top++] = k;
+            k = 2 * k;
+        }
+        k = stack[--top];
+        eytz[k - 1] = sorted[i++];
+        k = 2 * k + 1;
+    }
+}
+
+// Writes the sorted keys to path. With layout KEYFILE_SORTED a sparse index
+// with one entry per page of keys is appended. Returns 0 on success, -1 on error.
+int keyfile_write(const char *path, const uint64_t sorted[], uint64_t count, uint32_t key_width, uint32_t layout)
+{
+    struct keyfile_header h;
+    long page = sysconf(_SC_PAGESIZE);
+    uint64_t *eytz = NULL;
+    const uint64_t *src = sorted;
+    uint64_t i;
+    FILE *out;
+    int rc = -1;
+
+    if (key_width != 4 && key_width != 8)
+    {
+        return -1;
+    }
+
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, KEYFILE_MAGIC, 8);
+    h.count = count;
+    h.key_width = key_width;
+    h.layout = layout;
+    h.keys_offset = (uint64_t)page;
+
+    if (layout == KEYFILE_SORTED)
+    {
+        h.index_stride = (uint64_t)page / key_width;
+        h.index_count = (count + h.index_stride - 1) / h.index_stride;
+        h.index_offset = h.keys_offset + (count * key_width + page - 1) / page * page;
+    }
+    else
+    {
+        eytz = (uint64_t *)malloc((count ? count : 1) * sizeof(uint64_t));
+        if (eytz == NULL)
+        {
+            return -1;
+        }
+        eytzinger_fill(sorted, eytz, count);
+        src = eytz;
+    }
+
+    out = fopen(path, "wb");
+    if (out == NULL)
+    {
+        free(eytz);
+        return -1;
+    }
+
+    // Header, padded to the first page
+    if (fwrite(&h, sizeof(h), 1, out) != 1 || fseek(out, (long)h.keys_offset, SEEK_SET) != 0)
+    {
+        goto done;
+    }
+
+    // Keys, stdio does the buffering
+    for (i = 0; i < count; i++)
+    {
+        unsigned char key[8];
+
+        write_key(key, src[i], key_width);
+        if (fwrite(key, key_width, 1, out) != 1)
+        {
+            goto done;
+        }
+    }
+
+    // Sparse index, always 64-bit
+    if (h.index_count > 0)
+    {
+        if (fseek(out, (long)h.index_offset, SEEK_SET) != 0)
+        {
+            goto done;
+        }
+        for (i = 0; i < h.index_count; i++)
+        {
+            if (fwrite(&sorted[i * h.index_stride], sizeof(uint64_t), 1, out) != 1)
+            {
+                goto done;
+            }
+        }
+    }
+    rc = 0;
+
+done:
+    if (fclose(out) != 0)
+    {
+        rc = -1;
+    }
+    free(eytz);
+    return rc;
+}
+
+// ------------------------------------------------------------------
+// Reader
+// ------------------------------------------------------------------
+
+void keyfile_close(struct keyfile *kf)
+{
+    if (kf->map != NULL)
+    {
+        munmap((void *)kf->map, kf->map_bytes);
+    }
+    free(kf->top);
+    memset(kf, 0, sizeof(*kf));
+}
+
+// Maps the key file and loads its top-level index.
+// Returns 0 on success, -1 when the file cannot be mapped or is not a key file.
+int keyfile_open(struct keyfile *kf, const char *path)
+{
+    struct keyfile_header h;
+    struct stat st;
+    uint64_t i;
+    int fd;
+
+    memset(kf, 0, sizeof(*kf));
+
+    fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        return -1;
+    }
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(h))
+    {
+        close(fd);
+        return -1;
+    }
+
+    kf->map_bytes = (size_t)st.st_size;
+    kf->map = (const unsigned char *)mmap(NULL, kf->map_bytes, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (kf->map == MAP_FAILED)
+    {
+        kf->map = NULL;
+        return -1;
+    }
+
+    // Every size is checked by division, so a crafted header cannot wrap the
+    // bounds. The keys must be aligned for key_at() ; the sparse index is
+    // copied with memcpy() and must match the key count.
+    memcpy(&h, kf->map, sizeof(h));
+    if (memcmp(h.magic, KEYFILE_MAGIC, 8) != 0 || (h.key_width != 4 && h.key_width != 8)
+        || (h.layout != KEYFILE_SORTED && h.layout != KEYFILE_EYTZINGER)
+        || (h.count > 0
+            && (h.keys_offset > kf->map_bytes || h.keys_offset % h.key_width != 0
+                || h.count > (kf->map_bytes - h.keys_offset) / h.key_width))
+        || (h.index_count > 0
+            && (h.index_offset > kf->map_bytes || h.index_count > (kf->map_bytes - h.index_offset) / 8
+                || h.index_stride == 0
+                || h.index_count != h.count / h.index_stride + (h.count % h.index_stride != 0))))
+    {
+        keyfile_close(kf);
+        return -1;
+    }
+
+    kf->keys = kf->map + h.keys_offset;
+    kf->count = h.count;
+    kf->key_width = h.key_width;
+    kf->layout = h.layout;
+
+    // Lookups jump around : read-ahead would only pull in pages nobody asked for
+    madvise((void *)kf->map, kf->map_bytes, MADV_RANDOM);
+
+    if (kf->layout == KEYFILE_EYTZINGER)
+    {
+        kf->top_count = (kf->count < EYTZ_TOP_SLOTS) ? kf->count : EYTZ_TOP_SLOTS;
+        kf->top = (uint64_t *)malloc((kf->top_count + 1) * sizeof(uint64_t));
+        if (kf->top == NULL)
+        {
+            keyfile_close(kf);
+            return -1;
+        }
+        madvise((void *)kf->keys, kf->top_count * kf->key_width, MADV_WILLNEED);
+        for (i = 0; i < kf->top_count; i++)
+        {
+            kf->top[i] = key_at(kf, i);
+        }
+        return 0;
+    }
+
+    if (h.index_count > 0)
+    {
+        // Index stored in the file : one sequential read
+        const void *index = kf->map + h.index_offset;
+
+        kf->stride = h.index_stride;
+        kf->top_count = h.index_count;
+        kf->top = (uint64_t *)malloc(kf->top_count * sizeof(uint64_t));
+        if (kf->top == NULL)
+        {
+            keyfile_close(kf);
+            return -1;
+        }
+        madvise((void *)((uintptr_t)index & ~(uintptr_t)(sysconf(_SC_PAGESIZE) - 1)),
+                h.index_count * 8 + sysconf(_SC_PAGESIZE), MADV_WILLNEED);
+        memcpy(kf->top, index, kf->top_count * sizeof(uint64_t));
+    }
+    else
+    {
+        // No index : sample at most SAMPLE_LIMIT keys
+        kf->stride = (kf->count + SAMPLE_LIMIT - 1) / SAMPLE_LIMIT;
+        if (kf->stride == 0)
+        {
+            kf->stride = 1;
+        }
+        kf->top_count = (kf->count + kf->stride - 1) / kf->stride;
+        kf->top = (uint64_t *)malloc((kf->top_count ? kf->top_count : 1) * sizeof(uint64_t));
+        if (kf->top == NULL)
+        {
+            keyfile_close(kf);
+            return -1;
+        }
+        for (i = 0; i < kf->top_count; i++)
+        {
+            kf->top[i] = key_at(kf, i * kf->stride);
+        }
+    }
+    return 0;
+}
+
+// Finds the smallest key >= key. Returns 1 and writes it to *found, or 0 when
+// every key is smaller.
+int keyfile_lower_bound(const struct keyfile *kf, uint64_t key, uint64_t *found)
+{
+    uint64_t lo, hi;
+
+    if (kf->layout == KEYFILE_EYTZINGER)
+    {
+        uint64_t k = 1;
+
+        // Slot k is at position k - 1 : RAM for the top levels, then the mapping
+        while (k <= kf->top_count)
+        {
+            k = 2 * k + (kf->top[k - 1] < key);
+        }
+        while (k <= kf->count)
+        {
+            k = 2 * k + (key_at(kf, k - 1) < key);
+        }
+        k >>= __builtin_ctzll(~k) + 1;
+
+        if (k == 0)
+        {
+            return 0;
+        }
+        *found = (k <= kf->top_count) ? kf->top[k - 1] : key_at(kf, k - 1);
+        return 1;
+    }
+
+    // Last index entry <= key, in RAM
+    lo = 0;
+    hi = kf->top_count;
+    while (lo < hi)
+    {
+        uint64_t mid = lo + (hi - lo) / 2;
+
+        if (kf->top[mid] <= key)
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+
+    // The answer is in the block of that entry, or it is the next block's first key
+    lo = (lo > 0) ? (lo - 1) * kf->stride : 0;
+    hi = lo + kf->stride;
+    if (hi > kf->count)
+    {
+        hi = kf->count;
+    }
+    while (lo < hi)
+    {
+        uint64_t mid = lo + (hi - lo) / 2;
+
+        if (key_at(kf, mid) < key)
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+
+    if (lo >= kf->count)
+    {
+        return 0;
+    }
+    *found = key_at(kf, lo);
+    return 1;
+}
+
+int keyfile_contains(const struct keyfile *kf, uint64_t key)
+{
+    uint64_t found;
+
+    return keyfile_lower_bound(kf, key, &found) && found == key;
+}
+
+// ------------------------------------------------------------------
+// Demo
+// ------------------------------------------------------------------
+
+static long page_faults(void)
+{
+    struct rusage ru;
+
+    getrusage(RUSAGE_SELF, &ru);
+    return ru.ru_minflt + ru.ru_majflt;
+}
+
+// Keys 10, 20, 30 ... with some gaps
+static uint64_t *make_keys(uint64_t n)
+{
+    uint64_t *keys = (uint64_t *)malloc((n ? n : 1) * sizeof(uint64_t));
+    uint64_t i;
+
+    if (keys != NULL)
+    {
+        for (i = 0; i < n; i++)
+        {
+            keys[i] = 10 * i + 10 + (i / 1000) * 5;
+        }
+    }
+    return keys;
+}
+
+static void lookup_and_report(const struct keyfile *kf, uint64_t key)
+{
+    uint64_t found = 0;
+    long before = page_faults();
+    int ok = keyfile_lower_bound(kf, key, &found);
+
+    if (ok && found == key)
+    {
+        printf("  key %llu found (%ld page faults)\n", (unsigned long long)key, page_faults() - before);
+    }
+    else if (ok)
+    {
+        printf("  key %llu not found, next key %llu (%ld page faults)\n", (unsigned long long)key,
+               (unsigned long long)found, page_faults() - before);
+    }
+    else
+    {
+        printf("  key %llu not found, no greater key (%ld page faults)\n", (unsigned long long)key,
+               page_faults() - before);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    struct keyfile kf;
+    uint64_t n = 4000000, *keys;
+    int layout, i;
+
+    if (argc > 3 && strcmp(argv[1], "write") == 0)
+    {
+        n = strtoull(argv[3], NULL, 10);
+        layout = (argc > 4 && strcmp(argv[4], "eytz") == 0) ? KEYFILE_EYTZINGER : KEYFILE_SORTED;
+        keys = make_keys(n);
+        if (keys == NULL || keyfile_write(argv[2], keys, n, 8, layout) != 0)
+        {
+            printf("Cannot write %s\n", argv[2]);
+            free(keys);
+            return 1;
+        }
+        free(keys);
+        return 0;
+    }
+
+    if (argc > 3 && strcmp(argv[1], "find") == 0)
+    {
+        if (keyfile_open(&kf, argv[2]) != 0)
+        {
+            printf("Cannot open %s as a key file\n", argv[2]);
+            return 1;
+        }
+        for (i = 3; i < argc; i++)
+        {
+            lookup_and_report(&kf, strtoull(argv[i], NULL, 10));
+        }
+        keyfile_close(&kf);
+        return 0;
+    }
+
+    // Demo : write a 32 MB file in both layouts and look keys up
+    keys = make_keys(n);
+    if (keys == NULL)
+    {
+        printf("Out of memory.\n");
+        return 1;
+    }
+
+    for (layout = KEYFILE_SORTED; layout <= KEYFILE_EYTZINGER; layout++)
+    {
+        char path[] = "/tmp/dsa_keys_XXXXXX";
+        int fd = mkstemp(path);
+
+        if (fd < 0)
+        {
+            printf("Cannot create a temporary file.\n");
+            free(keys);
+            return 1;
+        }
+        close(fd);
+        if (keyfile_write(path, keys, n, 8, layout) != 0 || keyfile_open(&kf, path) != 0)
+        {
+            printf("Cannot create %s\n", path);
+            unlink(path);
+            free(keys);
+            return 1;
+        }
+
+        printf("%s layout, %llu keys, %llu in RAM :\n", layout == KEYFILE_SORTED ? "Sorted" : "Eytzinger",
+               (unsigned long long)kf.count, (unsigned long long)kf.top_count);
+        lookup_and_report(&kf, 10);
+        lookup_and_report(&kf, 12345675);
+        lookup_and_report(&kf, 12345676);
+        lookup_and_report(&kf, 39999990 + 19995);
+        lookup_and_report(&kf, 50000000);
+
+        keyfile_close(&kf);
+        unlink(path);
+    }
+
+    free(keys);
+    return 0;
+}
@@ -0,0 +1,568 @@
+// Vectorized linear search over unsorted int arrays.
+
+// linear_search.c compares one int per iteration. Here the array is scanned
+// 64 elements at a time : the kernel compares 8 (AVX2) or 16 (AVX-512) lanes
+// per instruction and turns the result into one 64-bit match mask. The same
+// masks answer every kind of query :
+//  - first match      -> first non-zero mask, stop early
+//  - all matches      -> index list (ctz over each mask) or a bitmap
+//  - match count      -> popcount of the masks
+// A match is defined by a predicate : equal to one target, equal to any of a
+// small set of targets, or inside a range [lo, hi].
+// The kernel is picked once at runtime from the CPU features, with a scalar
+// fallback for other CPUs and compilers.
+
+// Input : arr[] = { 1, 6, 2, 8, 4, 9, 15, 45, 87, 89}, target = 15
+// Output : The element 15 found at position 7.
+
+// Time Complexity : O(n)
+// Space Complexity : O(1) (the index list / bitmap is provided by the caller)
+
+// Compile : gcc -O2 SIMD_Linear_Search.c -o simd_search
+// Run     : ./simd_search              (small example)
+//           ./simd_search bench [logn] (GB/s against the scalar loop)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HAVE_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+// Largest target set accepted by predicate_any_of()
+#define MAX_TARGETS 16
+
+// Elements covered by one mask word
+#define WORD_BITS 64
+
+// Words produced per kernel call. 64 words = 4096 ints = 16 KB, small enough
+// to stay in L1 between the kernel and the consumer.
+#define CHUNK_WORDS 64
+
+enum predicate_kind
+{
+    PRED_EQUAL,
+    PRED_ANY_OF,
+    PRED_BETWEEN
+};
+
+struct scan_predicate
+{
+    enum predicate_kind kind;
+    int lo, hi;                 // target for PRED_EQUAL, bounds for PRED_BETWEEN
+    int targets[MAX_TARGETS];   // PRED_ANY_OF
+    int count;
+};
+
+struct scan_predicate predicate_equal(int target)
+{
+    struct scan_predicate p;
+
+    memset(&p, 0, sizeof(p));
+    p.kind = PRED_EQUAL;
+    p.lo = p.hi = target;
+    return p;
+}
+
+// Takes at most MAX_TARGETS targets, the rest are ignored.
+struct scan_predicate predicate_any_of(const int targets[], int count)
+{
+    struct scan_predicate p;
+    int i;
+
+    memset(&p, 0, sizeof(p));
+    p.kind = PRED_ANY_OF;
+    p.count = (count < MAX_TARGETS) ? count : MAX_TARGETS;
+    for (i = 0; i < p.count; i++)
+    {
+        p.targets[i] = targets[i];
+    }
+    return p;
+}
+
+struct scan_predicate predicate_between(int lo, int hi)
+{
+    struct scan_predicate p;
+
+    memset(&p, 0, sizeof(p));
+    p.kind = PRED_BETWEEN;
+    p.lo = lo;
+    p.hi = hi;
+    return p;
+}
+
+static int predicate_matches(const struct scan_predicate *p, int x)
+{
+    int i;
+
+    switch (p->kind)
+    {
+    case PRED_EQUAL:
+        return x == p->lo;
+    case PRED_BETWEEN:
+        return x >= p->lo && x <= p->hi;
+    default:
+        for (i = 0; i < p->count; i++)
+        {
+            if (x == p->targets[i])
+            {
+                return 1;
+            }
+        }
+        return 0;
+    }
+}
+
+// ------------------------------------------------------------------
+// Kernels : fill words[0 .. nwords) with the match masks of
+// arr[0 .. nwords * 64). Bit j of words[w] is the match of arr[w * 64 + j].
+// ------------------------------------------------------------------
+
+typedef void (*match_kernel)(const int arr[], size_t nwords, const struct scan_predicate *p, uint64_t words[]);
+
+static void match_words_scalar(const int arr[], size_t nwords, const struct scan_predicate *p, uint64_t words[])
+{
+    size_t w;
+    int j;
+
+    for (w = 0; w < nwords; w++)
+    {
+        uint64_t mask = 0;
+
+        for (j = 0; j < WORD_BITS; j++)
+        {
+            mask |= (uint64_t)predicate_matches(p, arr[w * WORD_BITS + j]) << j;
+        }
+        words[w] = mask;
+    }
+}
+
+#ifdef HAVE_X86_SIMD
+
+__attribute__((target("avx2")))
+static void match_words_avx2(const int arr[], size_t nwords, const struct scan_predicate *p, uint64_t words[])
+{
+    __m256i lo = _mm256_set1_epi32(p->lo);
+    __m256i hi = _mm256_set1_epi32(p->hi);
+    __m256i targets[MAX_TARGETS];
+    size_t w;
+    int i, j;
+
+    for (i = 0; i < p->count; i++)
+    {
+        targets[i] = _mm256_set1_epi32(p->targets[i]);
+    }
+
+    for (w = 0; w < nwords; w++)
+    {
+        const int *block = arr + w * WORD_BITS;
+        uint64_t mask = 0;
+
+        for (j = 0; j < WORD_BITS / 8; j++)
+        {
+            __m256i x = _mm256_loadu_si256((const __m256i *)(block + 8 * j));
+            __m256i m;
+
+            if (p->kind == PRED_EQUAL)
+            {
+                m = _mm256_cmpeq_epi32(x, lo);
+            }
+            else if (p->kind == PRED_BETWEEN)
+            {
+                // lo <= x <= hi  is  not (lo > x or x > hi)
+                m = _mm256_or_si256(_mm256_cmpgt_epi32(lo, x), _mm256_cmpgt_epi32(x, hi));
+                m = _mm256_xor_si256(m, _mm256_set1_epi32(-1));
+            }
+            else
+            {
+                m = _mm256_setzero_si256();
+                for (i = 0; i < p->count; i++)
+                {
+                    m = _mm256_or_si256(m, _mm256_cmpeq_epi32(x, targets[i]));
+                }
+            }
+
+            mask |= (uint64_t)(unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(m)) << (8 * j);
+        }
+        words[w] = mask;
+    }
+}
+
+__attribute__((target("avx512f")))
+static void match_words_avx512(const int arr[], size_t nwords, const struct scan_predicate *p, uint64_t words[])
+{
+    __m512i lo = _mm512_set1_epi32(p->lo);
+    __m512i hi = _mm512_set1_epi32(p->hi);
+    __m512i targets[MAX_TARGETS];
+    size_t w;
+    int i, j;
+
+    for (i = 0; i < p->count; i++)
+    {
+        targets[i] = _mm512_set1_epi32(p->targets[i]);
+    }
+
+    for (w = 0; w < nwords; w++)
+    {
+        const int *block = arr + w * WORD_BITS;
+        uint64_t mask = 0;
+
+        for (j = 0; j < WORD_BITS / 16; j++)
+        {
+            __m512i x = _mm512_loadu_si512((const void *)(block + 16 * j));
+            __mmask16 m;
+
+            if (p->kind == PRED_EQUAL)
+            {
+                m = _mm512_cmpeq_epi32_mask(x, lo);
+            }
+            else if (p->kind == PRED_BETWEEN)
+            {
+                m = _mm512_cmpge_epi32_mask(x, lo) & _mm512_cmple_epi32_mask(x, hi);
+            }
+            else
+            {
+                m = 0;
+                for (i = 0; i < p->count; i++)
+                {
+                    m |= _mm512_cmpeq_epi32_mask(x, targets[i]);
+                }
+            }
+
+            mask |= (uint64_t)m << (16 * j);
+        }
+        words[w] = mask;
+    }
+}
+
+#endif
+
+static match_kernel select_kernel(void)
+{
+#ifdef HAVE_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+    {
+        return match_words_avx512;
+    }
+    if (__builtin_cpu_supports("avx2"))
+    {
+        return match_words_avx2;
+    }
+#endif
+    return match_words_scalar;
+}
+
+static match_kernel active_kernel = NULL;
+
+static match_kernel get_kernel(void)
+{
+    if (active_kernel == NULL)
+    {
+        active_kernel = select_kernel();
+    }
+    return active_kernel;
+}
+
+// Name of the kernel picked for this CPU
+const char *scan_kernel_name(void)
+{
+    match_kernel k = get_kernel();
+
+#ifdef HAVE_X86_SIMD
+    if (k == match_words_avx512)
+    {
+        return "avx512";
+    }
+    if (k == match_words_avx2)
+    {
+        return "avx2";
+    }
+#endif
+    return (k == match_words_scalar) ? "scalar" : "unknown";
+}
+
+// Match mask of the last n % 64 elements
+static uint64_t match_tail(const int arr[], size_t n, const struct scan_predicate *p)
+{
+    uint64_t mask = 0;
+    size_t j;
+
+    for (j = 0; j < n; j++)
+    {
+        mask |= (uint64_t)predicate_matches(p, arr[j]) << j;
+    }
+    return mask;
+}
+
+static int ctz64(uint64_t x)
+{
+#if defined(__GNUC__)
+    return __builtin_ctzll(x);
+#else
+    int count = 0;
+
+    while ((x & 1) == 0)
+    {
+        x >>= 1;
+        count++;
+    }
+    return count;
+#endif
+}
+
+static int popcount64(uint64_t x)
+{
+#if defined(__GNUC__)
+    return __builtin_popcountll(x);
+#else
+    int count = 0;
+
+    while (x)
+    {
+        x &= x - 1;
+        count++;
+    }
+    return count;
+#endif
+}
+
+// ------------------------------------------------------------------
+// Public API
+// ------------------------------------------------------------------
+
+// Index of the first element matching p, or -1.
+long scan_first(const int arr[], size_t n, const struct scan_predicate *p)
+{
+    match_kernel kernel = get_kernel();
+    uint64_t words[CHUNK_WORDS];
+    size_t full = n / WORD_BITS, w = 0, i;
+    uint64_t tail;
+
+    while (w < full)
+    {
+        size_t m = (full - w < CHUNK_WORDS) ? full - w : CHUNK_WORDS;
+
+        kernel(arr + w * WORD_BITS, m, p, words);
+        for (i = 0; i < m; i++)
+        {
+            if (words[i] != 0)
+            {
+                return (long)((w + i) * WORD_BITS + ctz64(words[i]));
+            }
+        }
+        w += m;
+    }
+
+    tail = match_tail(arr + full * WORD_BITS, n % WORD_BITS, p);
+    return tail ? (long)(full * WORD_BITS + ctz64(tail)) : -1;
+}
+
+// Writes the indices of all matches (up to cap of them) into idx[].
+// Returns the total number of matches, which may be larger than cap.
+size_t scan_all(const int arr[], size_t n, const struct scan_predicate *p, size_t idx[], size_t cap)
+{
+    match_kernel kernel = get_kernel();
+    uint64_t words[CHUNK_WORDS + 1];
+    size_t full = n / WORD_BITS, w = 0, i, total = 0;
+
+    while (w <= full)
+    {
+        size_t m;
+
+        if (w < full)
+        {
+            m = (full - w < CHUNK_WORDS) ? full - w : CHUNK_WORDS;
+            kernel(arr + w * WORD_BITS, m, p, words);
+        }
+        else
+        {
+            m = 1;
+            words[0] = match_tail(arr + full * WORD_BITS, n % WORD_BITS, p);
+        }
+
+        for (i = 0; i < m; i++)
+        {
+            uint64_t mask = words[i];
+
+            while (mask)
+            {
+                if (total < cap)
+                {
+                    idx[total] = (w + i) * WORD_BITS + ctz64(mask);
+                }
+                total++;
+                mask &= mask - 1;
+            }
+        }
+        w += m;
+    }
+    return total;
+}
+
+// Writes the match bitmap of arr[] into bitmap[], which must hold
+// (n + 63) / 64 words. Returns the number of matches.
+size_t scan_bitmap(const int arr[], size_t n, const struct scan_predicate *p, uint64_t bitmap[])
+{
+    size_t full = n / WORD_BITS, w, total = 0;
+
+    get_kernel()(arr, full, p, bitmap);
+    if (n % WORD_BITS)
+    {
+        bitmap[full] = match_tail(arr + full * WORD_BITS, n % WORD_BITS, p);
+    }
+
+    for (w = 0; w < (n + WORD_BITS - 1) / WORD_BITS; w++)
+    {
+        total += popcount64(bitmap[w]);
+    }
+    return total;
+}
+
+// Number of elements matching p, without materializing anything.
+size_t scan_count(const int arr[], size_t n, const struct scan_predicate *p)
+{
+    match_kernel kernel = get_kernel();
+    uint64_t words[CHUNK_WORDS];
+    size_t full = n / WORD_BITS, w = 0, i, total = 0;
+
+    while (w < full)
+    {
+        size_t m = (full - w < CHUNK_WORDS) ? full - w : CHUNK_WORDS;
+
+        kernel(arr + w * WORD_BITS, m, p, words);
+        for (i = 0; i < m; i++)
+        {
+            total += popcount64(words[i]);
+        }
+        w += m;
+    }
+    return total + popcount64(match_tail(arr + full * WORD_BITS, n % WORD_BITS, p));
+}
+
+// Vectorized version of the loop in linear_search.c. Named apart from it,
+// since linear_search() there takes and returns int.
+long simd_linear_search(const int arr[], size_t n, int target)
+{
+    struct scan_predicate p = predicate_equal(target);
+
+    return scan_first(arr, n, &p);
+}
+
+// ------------------------------------------------------------------
+// Benchmark
+// ------------------------------------------------------------------
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// The loop of linear_search.c
+static long scalar_linear_search(const int arr[], size_t n, int target)
+{
+    size_t i;
+
+    for (i = 0; i < n; i++)
+    {
+        if (arr[i] == target)
+        {
+            return (long)i;
+        }
+    }
+    return -1;
+}
+
+static void run_benchmark(int log_n)
+{
+    size_t n = (size_t)1 << log_n, i;
+    int *arr = (int *)malloc(n * sizeof(int));
+    int set[4] = { -1, -2, -3, -4 };
+    struct scan_predicate absent = predicate_equal(-1);
+    struct scan_predicate any = predicate_any_of(set, 4);
+    struct scan_predicate range = predicate_between(1000, 1999);
+    double bytes = (double)n * sizeof(int), t0, t;
+    long r;
+
+    if (arr == NULL)
+    {
+        printf("Out of memory.\n");
+        return;
+    }
+
+    // Non-negative values, so the negative targets are never found and every
+    // query scans the whole array.
+    for (i = 0; i < n; i++)
+    {
+        arr[i] = (int)((i * 2654435761u) & 0x7fffffff) % 1000000;
+    }
+
+    printf("n = %zu (%.0f MB), kernel = %s\n", n, bytes / 1e6, scan_kernel_name());
+
+    t0 = now_seconds();
+    r = scalar_linear_search(arr, n, -1);
+    t = now_seconds() - t0;
+    printf("  scalar loop        : %6.2f GB/s (result %ld)\n", bytes / t / 1e9, r);
+
+    t0 = now_seconds();
+    r = scan_first(arr, n, &absent);
+    t = now_seconds() - t0;
+    printf("  scan_first         : %6.2f GB/s (result %ld)\n", bytes / t / 1e9, r);
+
+    t0 = now_seconds();
+    r = scan_first(arr, n, &any);
+    t = now_seconds() - t0;
+    printf("  scan_first 4 keys  : %6.2f GB/s (result %ld)\n", bytes / t / 1e9, r);
+
+    t0 = now_seconds();
+    r = (long)scan_count(arr, n, &range);
+    t = now_seconds() - t0;
+    printf("  scan_count range   : %6.2f GB/s (count %ld)\n", bytes / t / 1e9, r);
+
+    free(arr);
+}
+
+int main(int argc, char *argv[])
+{
+    int arr[] = { 1, 6, 2, 8, 4, 9, 15, 45, 87, 89};
+    size_t size = sizeof(arr) / sizeof(arr[0]), idx[10], i, count;
+    int target = 15, set[] = { 2, 9, 89 };
+    struct scan_predicate any = predicate_any_of(set, 3);
+    struct scan_predicate range = predicate_between(5, 20);
+    long result;
+
+    if (argc > 1 && strcmp(argv[1], "bench") == 0)
+    {
+        run_benchmark(argc > 2 ? atoi(argv[2]) : 26);
+        return 0;
+    }
+
+    result = simd_linear_search(arr, size, target);
+    if (result != -1)
+    {
+        printf("The element %d found at position %ld.\n", target, result + 1);
+    }
+    else
+    {
+        printf("The element %d is not found in the array.\n", target);
+    }
+
+    // count may exceed the capacity of idx[], only that many were written
+    count = scan_all(arr, size, &any, idx, sizeof(idx) / sizeof(idx[0]));
+    printf("Positions of { 2, 9, 89 } : ");
+    for (i = 0; i < count && i < sizeof(idx) / sizeof(idx[0]); i++)
+    {
+        printf("%zu ", idx[i] + 1);
+    }
+
+    printf("\nElements in [5, 20] : %zu\n", scan_count(arr, size, &range));
+
+    return 0;
+}
@@ -0,0 +1,452 @@
+// Benchmark harness for the searching programs.
+
+// Links linear_search.c, Binary_Search.c, Jump_Search.c and
+// Interpolation_Search.c as plain functions (their main() is compiled out
+// with -DSEARCH_NO_MAIN) and runs them on generated datasets :
+//   uniform    : keys spread evenly over the int range
+//   zipf       : heavy-tailed (Pareto) gaps, a few huge jumps between keys
+//   clustered  : dense runs of keys separated by large empty ranges
+//   duplicates : most keys repeated many times
+// Sizes go from 1 KB up to --max-mb, growing 4x per step. The data is
+// generated already sorted (as running sums of random gaps), so several GB
+// can be produced without a sort.
+// For every algorithm, dataset and size it reports ns/lookup, the hit ratio,
+// and on Linux the branch-miss and cache-miss rates from perf_event_open
+// (reported as -1 when the counters are not available). Output is CSV, or
+// JSON with --json, so runs can be compared to pick an algorithm per workload
+// and to catch regressions.
+// Linear and jump search get fewer queries on big arrays, so every run stays
+// within a fixed amount of work ; the ns/lookup figure is unaffected.
+
+// Compile : gcc -O2 -DSEARCH_NO_MAIN Search_Benchmark.c linear_search.c Binary_Search.c
+//               Jump_Search.c Interpolation_Search.c -o search_benchmark -lm
+// Run     : ./search_benchmark [--max-mb 64] [--queries 1000000] [--hit-ratio 0.5] [--json]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <limits.h>
+#include <math.h>
+#include <time.h>
+
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+// The searching programs, linked in with -DSEARCH_NO_MAIN
+int linear_search(int arr[], int size, int target);
+int binary_search(int arr[], int size, int target);
+int jump_search(int arr[], int n, int target);
+long interpolation_search(const int arr[], long n, int target);
+
+// Upper bound on elements touched per (algorithm, dataset, size) run
+#define WORK_BUDGET (1LL << 28)
+
+enum cost_model
+{
+    COST_LINEAR,
+    COST_SQRT,
+    COST_LOG
+};
+
+struct algorithm
+{
+    const char *name;
+    enum cost_model cost;
+};
+
+static const struct algorithm algorithms[] =
+{
+    { "linear", COST_LINEAR },
+    { "jump", COST_SQRT },
+    { "binary", COST_LOG },
+    { "interpolation", COST_LOG },
+};
+
+#define ALGORITHM_COUNT (int)(sizeof(algorithms) / sizeof(algorithms[0]))
+
+static const char *dataset_names[] = { "uniform", "zipf", "clustered", "duplicates" };
+
+#define DATASET_COUNT 4
+
+static long run_search(int algo, int arr[], long n, int target)
+{
+    switch (algo)
+    {
+    case 0:
+        return linear_search(arr, (int)n, target);
+    case 1:
+        return jump_search(arr, (int)n, target);
+    case 2:
+        return binary_search(arr, (int)n, target);
+    default:
+        return interpolation_search(arr, n, target);
+    }
+}
+
+// ------------------------------------------------------------------
+// Hardware counters
+// ------------------------------------------------------------------
+
+enum
+{
+    CTR_BRANCHES,
+    CTR_BRANCH_MISSES,
+    CTR_CACHE_REFS,
+    CTR_CACHE_MISSES,
+    CTR_COUNT
+};
+
+struct counters
+{
+    int fd[CTR_COUNT];
+    long long value[CTR_COUNT];
+};
+
+static void counters_open(struct counters *c)
+{
+    int i;
+
+    for (i = 0; i < CTR_COUNT; i++)
+    {
+        c->fd[i] = -1;
+        c->value[i] = -1;
+    }
+
+#ifdef __linux__
+    {
+        static const uint64_t config[CTR_COUNT] =
+        {
+            PERF_COUNT_HW_BRANCH_INSTRUCTIONS,
+            PERF_COUNT_HW_BRANCH_MISSES,
+            PERF_COUNT_HW_CACHE_REFERENCES,
+            PERF_COUNT_HW_CACHE_MISSES,
+        };
+
+        for (i = 0; i < CTR_COUNT; i++)
+        {
+            struct perf_event_attr pe;
+
+            memset(&pe, 0, sizeof(pe));
+            pe.type = PERF_TYPE_HARDWARE;
+            pe.size = sizeof(pe);
+            pe.config = config[i];
+            pe.disabled = 1;
+            pe.exclude_kernel = 1;
+            pe.exclude_hv = 1;
+            c->fd[i] = (int)syscall(__NR_perf_event_open, &pe, 0, -1, -1, 0);
+        }
+    }
+#endif
+}
+
+static void counters_close(struct counters *c)
+{
+#ifdef __linux__
+    int i;
+
+    for (i = 0; i < CTR_COUNT; i++)
+    {
+        if (c->fd[i] >= 0)
+        {
+            close(c->fd[i]);
+        }
+    }
+#else
+    (void)c;
+#endif
+}
+
+static void counters_start(struct counters *c)
+{
+#ifdef __linux__
+    int i;
+
+    for (i = 0; i < CTR_COUNT; i++)
+    {
+        if (c->fd[i] >= 0)
+        {
+            ioctl(c->fd[i], PERF_EVENT_IOC_RESET, 0);
+            ioctl(c->fd[i], PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+#else
+    (void)c;
+#endif
+}
+
+static void counters_stop(struct counters *c)
+{
+    int i;
+
+    for (i = 0; i < CTR_COUNT; i++)
+    {
+        c->value[i] = -1;
+#ifdef __linux__
+        if (c->fd[i] >= 0)
+        {
+            long long v;
+
+            ioctl(c->fd[i], PERF_EVENT_IOC_DISABLE, 0);
+            if (read(c->fd[i], &v, sizeof(v)) == (ssize_t)sizeof(v))
+            {
+                c->value[i] = v;
+            }
+        }
+#endif
+    }
+}
+
+// misses / total, or -1 when either counter is missing
+static double counter_rate(const struct counters *c, int misses, int total)
+{
+    if (c->value[misses] < 0 || c->value[total] <= 0)
+    {
+        return -1.0;
+    }
+    return (double)c->value[misses] / (double)c->value[total];
+}
+
+// ------------------------------------------------------------------
+// Data generators
+// ------------------------------------------------------------------
+
+static unsigned long long rng_state = 88172645463325252ULL;
+
+static unsigned long long next_random(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return rng_state;
+}
+
+static double next_unit(void)
+{
+    return (next_random() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+// Fills arr[] with n sorted keys as running sums of random gaps. The mean gap
+// is chosen so that the keys span roughly [0, INT_MAX] ; sums that would
+// overflow saturate at INT_MAX.
+static void generate_dataset(int arr[], long n, int kind)
+{
+    double mean = (double)INT_MAX / (double)n;
+    long long key = 0;
+    long i;
+
+    for (i = 0; i < n; i++)
+    {
+        double gap;
+
+        switch (kind)
+        {
+        case 0:
+            gap = 2.0 * mean * next_unit();
+            break;
+        case 1:
+            // Pareto(alpha = 1.5) has mean 3 ; scale back to the target mean
+            gap = mean / 3.0 * pow(1.0 - next_unit(), -1.0 / 1.5);
+            break;
+        case 2:
+            // 1 in 1024 gaps jumps over an empty range
+            gap = ((next_random() & 1023) == 0) ? mean * 512.0 : mean * 0.5 * next_unit();
+            break;
+        default:
+            // A new key for 1 in 64 elements, repeats otherwise
+            gap = ((next_random() & 63) == 0) ? mean * 64.0 : 0.0;
+            break;
+        }
+
+        key += (long long)gap;
+        arr[i] = (key > INT_MAX) ? INT_MAX : (int)key;
+    }
+}
+
+// Queries : hit_ratio of them are keys of the array, the rest random values
+static void generate_queries(const int arr[], long n, int queries[], long count, double hit_ratio)
+{
+    long i;
+
+    for (i = 0; i < count; i++)
+    {
+        if (next_unit() < hit_ratio)
+        {
+            queries[i] = arr[next_random() % (unsigned long long)n];
+        }
+        else
+        {
+            queries[i] = (int)(next_random() & INT_MAX);
+        }
+    }
+}
+
+// ------------------------------------------------------------------
+// Driver
+// ------------------------------------------------------------------
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static long queries_for(enum cost_model cost, long n, long max_queries)
+{
+    double per_query = (cost == COST_LINEAR) ? (double)n
+                     : (cost == COST_SQRT) ? sqrt((double)n) * 2
+                     : log2((double)n + 1) + 1;
+    long q = (long)(WORK_BUDGET / per_query);
+
+    if (q < 16)
+    {
+        q = 16;
+    }
+    return (q < max_queries) ? q : max_queries;
+}
+
+struct result
+{
+    const char *algorithm;
+    const char *dataset;
+    long n;
+    long queries;
+    double ns_per_lookup;
+    double hit_ratio;
+    double branch_miss_rate;
+    double cache_miss_rate;
+};
+
+static void print_result(const struct result *r, int json, int first)
+{
+    if (json)
+    {
+        printf("%s\n  {\"algorithm\": \"%s\", \"dataset\": \"%s\", \"n\": %ld, \"bytes\": %ld, "
+               "\"queries\": %ld, \"ns_per_lookup\": %.2f, \"hit_ratio\": %.4f, "
+               "\"branch_miss_rate\": %.4f, \"cache_miss_rate\": %.4f}",
+               first ? "" : ",", r->algorithm, r->dataset, r->n, r->n * (long)sizeof(int),
+               r->queries, r->ns_per_lookup, r->hit_ratio, r->branch_miss_rate, r->cache_miss_rate);
+    }
+    else
+    {
+        printf("%s,%s,%ld,%ld,%ld,%.2f,%.4f,%.4f,%.4f\n", r->algorithm, r->dataset, r->n,
+               r->n * (long)sizeof(int), r->queries, r->ns_per_lookup, r->hit_ratio,
+               r->branch_miss_rate, r->cache_miss_rate);
+    }
+    fflush(stdout);
+}
+
+int main(int argc, char *argv[])
+{
+    long max_bytes = 64L << 20, max_queries = 1000000, n, max_n, i;
+    double hit_ratio = 0.5;
+    int json = 0, first = 1, kind, algo;
+    int *arr, *queries;
+    struct counters ctr;
+
+    for (i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--max-mb") == 0 && i + 1 < argc)
+        {
+            max_bytes = atol(argv[++i]) << 20;
+        }
+        else if (strcmp(argv[i], "--queries") == 0 && i + 1 < argc)
+        {
+            max_queries = atol(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--hit-ratio") == 0 && i + 1 < argc)
+        {
+            hit_ratio = atof(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--json") == 0)
+        {
+            json = 1;
+        }
+        else
+        {
+            printf("Usage : %s [--max-mb 64] [--queries 1000000] [--hit-ratio 0.5] [--json]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    // The searches take int sizes
+    max_n = max_bytes / (long)sizeof(int);
+    if (max_n > INT_MAX)
+    {
+        max_n = INT_MAX;
+    }
+
+    arr = (int *)malloc(max_n * sizeof(int));
+    queries = (int *)malloc(max_queries * sizeof(int));
+    if (arr == NULL || queries == NULL || max_queries <= 0)
+    {
+        printf("Out of memory.\n");
+        free(arr);
+        free(queries);
+        return 1;
+    }
+
+    counters_open(&ctr);
+
+    if (json)
+    {
+        printf("[");
+    }
+    else
+    {
+        printf("algorithm,dataset,n,bytes,queries,ns_per_lookup,hit_ratio,branch_miss_rate,cache_miss_rate\n");
+    }
+
+    for (kind = 0; kind < DATASET_COUNT; kind++)
+    {
+        // From 1 KB up, 4x per step
+        for (n = 1024 / (long)sizeof(int); n <= max_n; n *= 4)
+        {
+            generate_dataset(arr, n, kind);
+            generate_queries(arr, n, queries, max_queries, hit_ratio);
+
+            for (algo = 0; algo < ALGORITHM_COUNT; algo++)
+            {
+                struct result r;
+                long count = queries_for(algorithms[algo].cost, n, max_queries), hits = 0, q;
+                double t0;
+
+                counters_start(&ctr);
+                t0 = now_seconds();
+                for (q = 0; q < count; q++)
+                {
+                    hits += run_search(algo, arr, n, queries[q]) >= 0;
+                }
+                r.ns_per_lookup = (now_seconds() - t0) / count * 1e9;
+                counters_stop(&ctr);
+
+                r.algorithm = algorithms[algo].name;
+                r.dataset = dataset_names[kind];
+                r.n = n;
+                r.queries = count;
+                r.hit_ratio = (double)hits / count;
+                r.branch_miss_rate = counter_rate(&ctr, CTR_BRANCH_MISSES, CTR_BRANCHES);
+                r.cache_miss_rate = counter_rate(&ctr, CTR_CACHE_MISSES, CTR_CACHE_REFS);
+
+                print_result(&r, json, first);
+                first = 0;
+            }
+        }
+    }
+
+    if (json)
+    {
+        printf("\n]\n");
+    }
+
+    counters_close(&ctr);
+    free(arr);
+    free(queries);
+    return 0;
+}
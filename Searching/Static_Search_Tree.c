@@ -0,0 +1,486 @@
+// Static search tree (S+ tree) : an implicit B+ tree laid out by cache lines.
+
+// Jump search skips sqrt(n) elements at a time and then scans the block,
+// touching up to sqrt(n) cache lines. Here every node is STREE_B sorted keys
+// (16 ints = one 64-byte line, or 32 ints = two lines) with STREE_B + 1
+// children, so a lookup touches about log_17(n) lines :
+//  - the leaf layer is the sorted array itself, padded with INT_MAX,
+//  - every upper layer holds, for each key slot, the smallest key of the
+//    subtree to its right,
+//  - layers are stored one after another, leaves first, root last, and the
+//    children of node k in the layer below are nodes k * (B + 1) + i.
+// Inside a node the rank of the target (number of keys < target) is one SIMD
+// compare plus a popcount, and that rank is the child to descend into.
+// Since the leaves are the sorted keys, the final leaf slot is directly the
+// lower_bound index in the original array.
+// On Linux the tree can be placed on huge pages so TLB misses do not dominate
+// on multi-GB arrays.
+
+// Input : arr[] = {1, 3, 5, 7, 9, 11, 13, 15, 17, 19}, target = 11
+// Output : The Element ( 11 ) found at position 6.
+
+// Time Complexity : O(n) build, O(log_(B+1) n) per lookup
+// Space Complexity : O(n + n / B)
+
+// Compile : gcc -O2 Static_Search_Tree.c -o stree
+// Run     : ./stree                   (small example)
+//           ./stree bench [logn] [huge] (against binary and jump search)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <math.h>
+#include <time.h>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HAVE_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+// Keys per node : 16 (one cache line) or 32 (two cache lines)
+#ifndef STREE_B
+#define STREE_B 16
+#endif
+
+#define CACHE_LINE 64
+#define HUGE_PAGE (2UL * 1024 * 1024)
+#define STREE_MAX_HEIGHT 16
+
+struct static_search_tree
+{
+    int *keys;                          // all layers, leaves first
+    size_t n;                           // number of real keys
+    int height;                         // number of layers
+    size_t offset[STREE_MAX_HEIGHT];    // first key of every layer
+    size_t bytes;                       // size of the allocation
+    int mapped;                         // 1 when keys came from mmap
+    int huge;                           // 1 only on reserved (MAP_HUGETLB) pages
+};
+
+// Nodes needed for n keys
+static size_t stree_blocks(size_t n)
+{
+    return (n + STREE_B - 1) / STREE_B;
+}
+
+// Keys in the layer above a layer of n keys
+static size_t stree_prev_keys(size_t n)
+{
+    return (stree_blocks(n) + STREE_B) / (STREE_B + 1) * STREE_B;
+}
+
+static int *stree_alloc(struct static_search_tree *t, size_t count, int use_huge_pages)
+{
+    t->mapped = t->huge = 0;
+    t->bytes = (count * sizeof(int) + CACHE_LINE - 1) / CACHE_LINE * CACHE_LINE;
+
+#ifdef __linux__
+    if (use_huge_pages)
+    {
+        size_t bytes = (t->bytes + HUGE_PAGE - 1) / HUGE_PAGE * HUGE_PAGE;
+        void *p;
+
+#ifdef MAP_HUGETLB
+        // Reserved huge pages first, they are never split by the kernel
+        p = mmap(NULL, bytes, PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (p != MAP_FAILED)
+        {
+            t->mapped = t->huge = 1;
+            t->bytes = bytes;
+            return (int *)p;
+        }
+#endif
+        // Otherwise ask for transparent huge pages on a normal mapping, which
+        // the kernel may or may not grant
+        p = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p != MAP_FAILED)
+        {
+#ifdef MADV_HUGEPAGE
+            madvise(p, bytes, MADV_HUGEPAGE);
+#endif
+            t->mapped = 1;
+            t->bytes = bytes;
+            return (int *)p;
+        }
+    }
+#else
+    (void)use_huge_pages;
+#endif
+
+    return (int *)aligned_alloc(CACHE_LINE, t->bytes);
+}
+
+void stree_free(struct static_search_tree *t)
+{
+#ifdef __linux__
+    if (t->mapped)
+    {
+        munmap(t->keys, t->bytes);
+        t->keys = NULL;
+        return;
+    }
+#endif
+    free(t->keys);
+    t->keys = NULL;
+}
+
+// Builds the tree from a sorted array. Returns 0 on success, -1 when out of memory.
+int stree_build(struct static_search_tree *t, const int sorted[], size_t n, int use_huge_pages)
+{
+    size_t layer_keys = n, total = 0, leaf_keys, i;
+    int h;
+
+    // Layer sizes and offsets, leaves first, until a layer fits in one node
+    t->n = n;
+    t->height = 0;
+    for (;;)
+    {
+        size_t keys = stree_blocks(layer_keys) * STREE_B;
+
+        if (keys == 0)
+        {
+            keys = STREE_B;
+        }
+        t->offset[t->height++] = total;
+        total += keys;
+
+        if (keys == STREE_B)
+        {
+            break;
+        }
+        layer_keys = stree_prev_keys(layer_keys);
+    }
+    leaf_keys = (t->height > 1) ? t->offset[1] : total;
+
+    t->keys = stree_alloc(t, total, use_huge_pages);
+    if (t->keys == NULL)
+    {
+        return -1;
+    }
+
+    // Leaves : the sorted keys, padded with INT_MAX
+    memcpy(t->keys, sorted, n * sizeof(int));
+    for (i = n; i < leaf_keys; i++)
+    {
+        t->keys[i] = INT_MAX;
+    }
+
+    // Upper layers : slot j of node k separates child j and child j + 1, so it
+    // stores the smallest key of child j + 1, found by going down its leftmost path.
+    for (h = 1; h < t->height; h++)
+    {
+        size_t count = ((h + 1 < t->height) ? t->offset[h + 1] : total) - t->offset[h];
+
+        for (i = 0; i < count; i++)
+        {
+            size_t k = i / STREE_B, j = i % STREE_B;
+            int l;
+
+            k = k * (STREE_B + 1) + j + 1;
+            for (l = 1; l < h; l++)
+            {
+                k *= STREE_B + 1;
+            }
+            t->keys[t->offset[h] + i] = (k * STREE_B < n) ? t->keys[k * STREE_B] : INT_MAX;
+        }
+    }
+
+    return 0;
+}
+
+// ------------------------------------------------------------------
+// Node rank : number of keys in node[0 .. STREE_B) that are < target
+// ------------------------------------------------------------------
+
+static size_t stree_search_scalar(const struct static_search_tree *t, int target)
+{
+    size_t k = 0;
+    int h;
+
+    for (h = t->height - 1; h >= 0; h--)
+    {
+        const int *node = t->keys + t->offset[h] + k * STREE_B;
+        size_t rank = 0;
+        int j;
+
+        for (j = 0; j < STREE_B; j++)
+        {
+            rank += node[j] < target;
+        }
+        k = (h > 0) ? k * (STREE_B + 1) + rank : k * STREE_B + rank;
+    }
+    return k;
+}
+
+#ifdef HAVE_X86_SIMD
+
+__attribute__((target("avx2,popcnt")))
+static size_t stree_search_avx2(const struct static_search_tree *t, int target)
+{
+    __m256i x = _mm256_set1_epi32(target);
+    size_t k = 0;
+    int h;
+
+    for (h = t->height - 1; h >= 0; h--)
+    {
+        const int *node = t->keys + t->offset[h] + k * STREE_B;
+        unsigned mask = 0;
+        int j;
+
+        for (j = 0; j < STREE_B; j += 8)
+        {
+            __m256i y = _mm256_load_si256((const __m256i *)(node + j));
+            __m256i less = _mm256_cmpgt_epi32(x, y);
+
+            mask |= (unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(less)) << j;
+        }
+        k = (h > 0) ? k * (STREE_B + 1) + __builtin_popcount(mask)
+                    : k * STREE_B + __builtin_popcount(mask);
+    }
+    return k;
+}
+
+__attribute__((target("avx512f,popcnt")))
+static size_t stree_search_avx512(const struct static_search_tree *t, int target)
+{
+    __m512i x = _mm512_set1_epi32(target);
+    size_t k = 0;
+    int h;
+
+    for (h = t->height - 1; h >= 0; h--)
+    {
+        const int *node = t->keys + t->offset[h] + k * STREE_B;
+        unsigned mask = 0;
+        int j;
+
+        for (j = 0; j < STREE_B; j += 16)
+        {
+            __m512i y = _mm512_load_si512((const void *)(node + j));
+
+            mask |= (unsigned)_mm512_cmplt_epi32_mask(y, x) << j;
+        }
+        k = (h > 0) ? k * (STREE_B + 1) + __builtin_popcount(mask)
+                    : k * STREE_B + __builtin_popcount(mask);
+    }
+    return k;
+}
+
+#endif
+
+typedef size_t (*stree_kernel)(const struct static_search_tree *t, int target);
+
+static stree_kernel active_kernel = NULL;
+
+static stree_kernel get_kernel(void)
+{
+    if (active_kernel == NULL)
+    {
+        active_kernel = stree_search_scalar;
+#ifdef HAVE_X86_SIMD
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f"))
+        {
+            active_kernel = stree_search_avx512;
+        }
+        else if (__builtin_cpu_supports("avx2"))
+        {
+            active_kernel = stree_search_avx2;
+        }
+#endif
+    }
+    return active_kernel;
+}
+
+// Index of the first key >= target in the original sorted array, or n.
+size_t stree_lower_bound(const struct static_search_tree *t, int target)
+{
+    size_t pos = get_kernel()(t, target);
+
+    return (pos < t->n) ? pos : t->n;
+}
+
+// Index of target in the original sorted array, or -1.
+long stree_search(const struct static_search_tree *t, int target)
+{
+    size_t pos = stree_lower_bound(t, target);
+
+    return (pos < t->n && t->keys[pos] == target) ? (long)pos : -1;
+}
+
+// ------------------------------------------------------------------
+// Benchmark
+// ------------------------------------------------------------------
+
+static long jump_search(const int arr[], long n, int target)
+{
+    long step = (long)sqrt((double)n), prev = 0, jump = step, i;
+
+    while (arr[(jump < n ? jump : n) - 1] < target)
+    {
+        prev = jump;
+        jump += step;
+
+        if (prev >= n)
+        {
+            return -1;
+        }
+    }
+
+    for (i = prev; i < (jump < n ? jump : n); i++)
+    {
+        if (arr[i] == target)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static long binary_search(const int arr[], long n, int target)
+{
+    long left = 0, right = n - 1, mid;
+
+    while (left <= right)
+    {
+        mid = left + (right - left) / 2;
+
+        if (arr[mid] == target)
+        {
+            return mid;
+        }
+        else if (arr[mid] < target)
+        {
+            left = mid + 1;
+        }
+        else
+        {
+            right = mid - 1;
+        }
+    }
+    return -1;
+}
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static unsigned long long rng_state = 88172645463325252ULL;
+
+static unsigned long long next_random(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return rng_state;
+}
+
+static void run_benchmark(int log_n, int use_huge_pages)
+{
+    long n = 1L << log_n, queries = 1L << 21, jump_queries = 1L << 14, i;
+    int *arr = (int *)malloc(n * sizeof(int));
+    int *keys = (int *)malloc(queries * sizeof(int));
+    struct static_search_tree tree;
+    long found[3] = {0, 0, 0};
+    double t0, t_jump, t_binary, t_tree;
+
+    if (arr == NULL || keys == NULL)
+    {
+        printf("Out of memory.\n");
+        free(arr);
+        free(keys);
+        return;
+    }
+
+    for (i = 0; i < n; i++)
+    {
+        arr[i] = (int)(2 * i);
+    }
+    for (i = 0; i < queries; i++)
+    {
+        keys[i] = (int)(next_random() % (2 * n));
+    }
+
+    t0 = now_seconds();
+    if (stree_build(&tree, arr, n, use_huge_pages) != 0)
+    {
+        printf("Out of memory.\n");
+        free(arr);
+        free(keys);
+        return;
+    }
+    printf("n = %ld, height %d, build %.1f ms, huge pages %s\n", n, tree.height,
+           (now_seconds() - t0) * 1e3, tree.huge ? "reserved" : tree.mapped ? "advised (THP)" : "off");
+
+    t0 = now_seconds();
+    for (i = 0; i < jump_queries; i++)
+    {
+        found[0] += jump_search(arr, n, keys[i]) >= 0;
+    }
+    t_jump = (now_seconds() - t0) / jump_queries;
+
+    t0 = now_seconds();
+    for (i = 0; i < queries; i++)
+    {
+        found[1] += binary_search(arr, n, keys[i]) >= 0;
+    }
+    t_binary = (now_seconds() - t0) / queries;
+
+    t0 = now_seconds();
+    for (i = 0; i < queries; i++)
+    {
+        found[2] += stree_search(&tree, keys[i]) >= 0;
+    }
+    t_tree = (now_seconds() - t0) / queries;
+
+    printf("  jump search   : %10.1f ns / lookup (%ld of %ld found)\n", t_jump * 1e9, found[0], jump_queries);
+    printf("  binary search : %10.1f ns / lookup (%ld of %ld found)\n", t_binary * 1e9, found[1], queries);
+    printf("  S+ tree       : %10.1f ns / lookup (%ld of %ld found)\n", t_tree * 1e9, found[2], queries);
+
+    stree_free(&tree);
+    free(arr);
+    free(keys);
+}
+
+int main(int argc, char *argv[])
+{
+    int arr[] = {1, 3, 5, 7, 9, 11, 13, 15, 17, 19};
+    size_t n = sizeof(arr) / sizeof(arr[0]);
+    int target = 11;
+    struct static_search_tree tree;
+    long result;
+
+    if (argc > 1 && strcmp(argv[1], "bench") == 0)
+    {
+        run_benchmark(argc > 2 ? atoi(argv[2]) : 24, argc > 3 && strcmp(argv[3], "huge") == 0);
+        return 0;
+    }
+
+    if (stree_build(&tree, arr, n, 0) != 0)
+    {
+        printf("Out of memory.\n");
+        return 1;
+    }
+
+    result = stree_search(&tree, target);
+    if (result != -1)
+    {
+        printf("\nThe Element ( %d ) found at position %ld.\n", target, result + 1);
+    }
+    else
+    {
+        printf("\nElement not found.\n");
+    }
+
+    stree_free(&tree);
+    return 0;
+}
@@ -1,19 +1,34 @@
-
 #include<stdio.h>
-int main()
+
+// Returns the index of target in arr[], or -1 when it is not present.
+int linear_search(int arr[], int size, int target)
 {
-    int arr[] = { 1, 6, 2, 8, 4, 9, 15, 45, 87, 89};
-    int i, size = sizeof(arr) / sizeof(arr[0]);
-    int target = 15;
+    int i;
 
     for ( i = 0; i < size; i++)
     {
         if (arr[i] == target)
         {
-            printf("The element %d found at position %d.",arr[i],i+1);
-            break;
+            return i;
         }
         
     }
+    return -1;
+}
+
+// Search_Benchmark.c links this file with -DSEARCH_NO_MAIN
+#ifndef SEARCH_NO_MAIN
+int main()
+{
+    int arr[] = { 1, 6, 2, 8, 4, 9, 15, 45, 87, 89};
+    int i, size = sizeof(arr) / sizeof(arr[0]);
+    int target = 15;
+
+    i = linear_search(arr, size, target);
+    if (i != -1)
+    {
+        printf("The element %d found at position %d.",arr[i],i+1);
+    }
     return 0;    
-}
\ No newline at end of file
+}
+#endif
@@ -0,0 +1,879 @@
+// Sorting ints and 64-bit keys : LSD radix sort, parallel sample sort and a
+// SIMD sorting network for small blocks.
+
+// Input : arr[] = {29, -3, 1000000, 7, 0, -3, 42, 8, -2147483648, 15}
+// Output : -2147483648 -3 -3 0 7 8 15 29 42 1000000
+
+//  - LSD radix sort : 8 bits per pass, least significant digit first. Each
+//    pass is a stable counting sort (histogram, prefix sum, scatter), so
+//    after the last pass the keys are in order. The histograms of all passes
+//    come from one read of the keys, and a pass whose digit is the same for
+//    every key is skipped. Signed ints get their sign bit flipped on the fly.
+//    A payload as wide as the key (a 32-bit index with 32-bit keys, a 64-bit
+//    index or a pointer with 64-bit keys) can travel with each key.
+//  - Sample sort : random samples give threads * 4 splitters (buckets). The
+//    threads tag every value with its bucket and count them per chunk, the
+//    counts give every (bucket, chunk) pair its place, the values are
+//    scattered, then the buckets are radix sorted independently, taken from
+//    an atomic counter. A splitter drawn more than once is a value that fills
+//    a whole bucket or more : it gets a bucket of its own, which holds only
+//    copies of it and needs no sorting, so heavy duplicates (down to an array
+//    of equal values) do not pile up in one bucket.
+//  - Small blocks : a bitonic sorting network on one AVX-512 (16 ints) or
+//    AVX2 (8 ints) register, padded with INT_MAX. Each of the 10 (or 6)
+//    stages is a permute and a min / max. Arrays below QUICK_LIMIT are
+//    quicksorted down to blocks of that size instead of radix sorted.
+// Every function sorts in place and needs n extra keys (and payloads) of
+// memory ; it returns 0, or -1 when that memory cannot be allocated.
+// The sorted-input programs (Union_Intersection.c, Duplicate_Remove.c ...)
+// can link this file compiled with -DSORT_NO_MAIN to sort raw data first.
+
+// Time Complexity : O(n * bytes per key), O(n / threads) per thread in parallel
+// Space Complexity : O(n)
+
+// Compile : gcc -O2 -pthread Parallel_Sort.c -o parallel_sort
+// Run     : ./parallel_sort              (small example)
+//           ./parallel_sort bench [logn] (against qsort, M keys / s)
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<limits.h>
+#include<time.h>
+#include<pthread.h>
+#include<unistd.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HAVE_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+#define RADIX_BITS 8
+#define RADIX_SIZE (1 << RADIX_BITS)
+
+// Below this, quicksort with the network as base case beats the radix passes
+#define QUICK_LIMIT 512
+
+#define MAX_THREADS 64
+
+// Smallest chunk worth a thread
+#define MIN_CHUNK (1 << 16)
+
+// Buckets per thread, and samples per bucket for the splitters
+#define BUCKETS_PER_THREAD 4
+#define SAMPLES_PER_BUCKET 64
+
+#define SIGN_FLIP 0x80000000u
+
+// ------------------------------------------------------------------
+// Sorting network
+// ------------------------------------------------------------------
+
+// Sorts up to `width` ints
+typedef void (*network_kernel)(int *, size_t);
+
+struct network
+{
+    network_kernel sort;
+    size_t width;
+};
+
+// Fallback : insertion sort
+static void network_scalar(int a[], size_t n)
+{
+    size_t i;
+
+    for (i = 1; i < n; i++)
+    {
+        int x = a[i];
+        size_t j = i;
+
+        while (j > 0 && a[j - 1] > x)
+        {
+            a[j] = a[j - 1];
+            j--;
+        }
+        a[j] = x;
+    }
+}
+
+#ifdef HAVE_X86_SIMD
+
+// Bitonic stages for `lanes` lanes : partner[s][i] = i ^ j, and lane i keeps
+// the max when it is the upper lane of an ascending pair or the lower lane of
+// a descending one.
+struct bitonic_stages
+{
+    int count;
+    int partner[10][16];
+    int keep_max[10][16];
+};
+
+static void build_stages(struct bitonic_stages *st, int lanes)
+{
+    int k, j, i;
+
+    st->count = 0;
+    for (k = 2; k <= lanes; k *= 2)
+    {
+        for (j = k / 2; j > 0; j /= 2)
+        {
+            for (i = 0; i < lanes; i++)
+            {
+                int ascending = ((i & k) == 0), upper = ((i & j) != 0);
+
+                st->partner[st->count][i] = i ^ j;
+                st->keep_max[st->count][i] = (upper == ascending) ? -1 : 0;
+            }
+            st->count++;
+        }
+    }
+}
+
+static struct bitonic_stages stages8, stages16;
+
+__attribute__((target("avx2")))
+static void network_avx2(int a[], size_t n)
+{
+    __m256i mask = _mm256_cmpgt_epi32(_mm256_set1_epi32((int)n), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+    __m256i v = _mm256_blendv_epi8(_mm256_set1_epi32(INT_MAX), _mm256_maskload_epi32(a, mask), mask);
+    int s;
+
+    for (s = 0; s < stages8.count; s++)
+    {
+        __m256i other = _mm256_permutevar8x32_epi32(v, _mm256_loadu_si256((const __m256i *)stages8.partner[s]));
+
+        v = _mm256_blendv_epi8(_mm256_min_epi32(v, other), _mm256_max_epi32(v, other),
+                               _mm256_loadu_si256((const __m256i *)stages8.keep_max[s]));
+    }
+    _mm256_maskstore_epi32(a, mask, v);
+}
+
+__attribute__((target("avx512f")))
+static void network_avx512(int a[], size_t n)
+{
+    __mmask16 mask = (__mmask16)((1u << n) - 1);
+    __m512i v = _mm512_mask_loadu_epi32(_mm512_set1_epi32(INT_MAX), mask, a);
+    int s;
+
+    for (s = 0; s < stages16.count; s++)
+    {
+        __m512i other = _mm512_permutexvar_epi32(_mm512_loadu_si512((const void *)stages16.partner[s]), v);
+        __mmask16 take_max = _mm512_cmpneq_epi32_mask(_mm512_loadu_si512((const void *)stages16.keep_max[s]),
+                                                      _mm512_setzero_si512());
+
+        v = _mm512_mask_blend_epi32(take_max, _mm512_min_epi32(v, other), _mm512_max_epi32(v, other));
+    }
+    _mm512_mask_storeu_epi32(a, mask, v);
+}
+
+#endif
+
+static struct network chosen_network = {network_scalar, 16};
+static pthread_once_t network_once = PTHREAD_ONCE_INIT;
+
+static void pick_network(void)
+{
+#ifdef HAVE_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+    {
+        build_stages(&stages16, 16);
+        chosen_network.sort = network_avx512;
+    }
+    else if (__builtin_cpu_supports("avx2"))
+    {
+        build_stages(&stages8, 8);
+        chosen_network.sort = network_avx2;
+        chosen_network.width = 8;
+    }
+#endif
+}
+
+// The stage tables are built once, even when several threads sort at once
+static const struct network *get_network(void)
+{
+    pthread_once(&network_once, pick_network);
+    return &chosen_network;
+}
+
+// Quicksort (median of three) down to blocks the network sorts
+static void small_sort(int a[], size_t n, const struct network *net)
+{
+    while (n > net->width)
+    {
+        size_t mid = n / 2, i = 0, j = n - 1;
+        int pivot, t;
+
+        // Median of a[0], a[mid], a[n - 1], which also become sentinels
+        if (a[mid] < a[0])
+        {
+            t = a[mid]; a[mid] = a[0]; a[0] = t;
+        }
+        if (a[n - 1] < a[0])
+        {
+            t = a[n - 1]; a[n - 1] = a[0]; a[0] = t;
+        }
+        if (a[n - 1] < a[mid])
+        {
+            t = a[n - 1]; a[n - 1] = a[mid]; a[mid] = t;
+        }
+        pivot = a[mid];
+
+        // Hoare partition : a[0 .. j] <= pivot <= a[j + 1 .. n)
+        for (;;)
+        {
+            while (a[i] < pivot)
+            {
+                i++;
+            }
+            while (a[j] > pivot)
+            {
+                j--;
+            }
+            if (i >= j)
+            {
+                break;
+            }
+            t = a[i]; a[i] = a[j]; a[j] = t;
+            i++;
+            j--;
+        }
+
+        // Recurse into the smaller side, loop on the bigger one
+        if (j + 1 < n - j - 1)
+        {
+            small_sort(a, j + 1, net);
+            a += j + 1;
+            n -= j + 1;
+        }
+        else
+        {
+            small_sort(a + j + 1, n - j - 1, net);
+            n = j + 1;
+        }
+    }
+    net->sort(a, n);
+}
+
+// ------------------------------------------------------------------
+// LSD radix sort
+// ------------------------------------------------------------------
+
+// Sorts keys[0 .. n) using tmp[] as scratch, keys taken as key ^ flip.
+// Payloads (when not NULL) move with their keys. Returns the buffer holding
+// the result : keys or tmp.
+static unsigned int *radix_u32(unsigned int *keys, unsigned int *tmp, unsigned int *payload,
+                               unsigned int *payload_tmp, size_t n, unsigned int flip)
+{
+    size_t counts[4][RADIX_SIZE];
+    size_t i;
+    int pass, d;
+
+    memset(counts, 0, sizeof(counts));
+    for (i = 0; i < n; i++)
+    {
+        unsigned int k = keys[i] ^ flip;
+
+        counts[0][k & 0xFF]++;
+        counts[1][(k >> 8) & 0xFF]++;
+        counts[2][(k >> 16) & 0xFF]++;
+        counts[3][k >> 24]++;
+    }
+
+    for (pass = 0; pass < 4; pass++)
+    {
+        int shift = pass * RADIX_BITS;
+        size_t offset = 0;
+        unsigned int *swap;
+
+        // Every key has the same digit : nothing moves
+        if (n == 0 || counts[pass][((keys[0] ^ flip) >> shift) & 0xFF] == n)
+        {
+            continue;
+        }
+        for (d = 0; d < RADIX_SIZE; d++)
+        {
+            size_t c = counts[pass][d];
+
+            counts[pass][d] = offset;
+            offset += c;
+        }
+
+        if (payload != NULL)
+        {
+            for (i = 0; i < n; i++)
+            {
+                size_t at = counts[pass][((keys[i] ^ flip) >> shift) & 0xFF]++;
+
+                tmp[at] = keys[i];
+                payload_tmp[at] = payload[i];
+            }
+            swap = payload;
+            payload = payload_tmp;
+            payload_tmp = swap;
+        }
+        else
+        {
+            for (i = 0; i < n; i++)
+            {
+                tmp[counts[pass][((keys[i] ^ flip) >> shift) & 0xFF]++] = keys[i];
+            }
+        }
+        swap = keys;
+        keys = tmp;
+        tmp = swap;
+    }
+    return keys;
+}
+
+static unsigned long long *radix_u64(unsigned long long *keys, unsigned long long *tmp,
+                                     unsigned long long *payload, unsigned long long *payload_tmp, size_t n)
+{
+    size_t (*counts)[RADIX_SIZE] = (size_t (*)[RADIX_SIZE])calloc(8 * RADIX_SIZE, sizeof(size_t));
+    size_t i;
+    int pass, d;
+
+    if (counts == NULL)
+    {
+        return NULL;
+    }
+    for (i = 0; i < n; i++)
+    {
+        unsigned long long k = keys[i];
+
+        for (pass = 0; pass < 8; pass++)
+        {
+            counts[pass][(k >> (pass * RADIX_BITS)) & 0xFF]++;
+        }
+    }
+
+    for (pass = 0; pass < 8; pass++)
+    {
+        int shift = pass * RADIX_BITS;
+        size_t offset = 0;
+        unsigned long long *swap;
+
+        if (n == 0 || counts[pass][(keys[0] >> shift) & 0xFF] == n)
+        {
+            continue;
+        }
+        for (d = 0; d < RADIX_SIZE; d++)
+        {
+            size_t c = counts[pass][d];
+
+            counts[pass][d] = offset;
+            offset += c;
+        }
+
+        if (payload != NULL)
+        {
+            for (i = 0; i < n; i++)
+            {
+                size_t at = counts[pass][(keys[i] >> shift) & 0xFF]++;
+
+                tmp[at] = keys[i];
+                payload_tmp[at] = payload[i];
+            }
+            swap = payload;
+            payload = payload_tmp;
+            payload_tmp = swap;
+        }
+        else
+        {
+            for (i = 0; i < n; i++)
+            {
+                tmp[counts[pass][(keys[i] >> shift) & 0xFF]++] = keys[i];
+            }
+        }
+        swap = keys;
+        keys = tmp;
+        tmp = swap;
+    }
+    free(counts);
+    return keys;
+}
+
+// Sorts keys[] (and payload[] along, may be NULL)
+int radix_sort_u32(unsigned int keys[], unsigned int payload[], size_t n)
+{
+    unsigned int *tmp = (unsigned int *)malloc((n ? n : 1) * sizeof(unsigned int));
+    unsigned int *payload_tmp = NULL, *result;
+
+    if (tmp == NULL)
+    {
+        return -1;
+    }
+    if (payload != NULL)
+    {
+        payload_tmp = (unsigned int *)malloc((n ? n : 1) * sizeof(unsigned int));
+        if (payload_tmp == NULL)
+        {
+            free(tmp);
+            return -1;
+        }
+    }
+
+    result = radix_u32(keys, tmp, payload, payload_tmp, n, 0);
+    if (result != keys)
+    {
+        // Odd number of passes : the payloads ended in their scratch too
+        memcpy(keys, tmp, n * sizeof(unsigned int));
+        if (payload != NULL)
+        {
+            memcpy(payload, payload_tmp, n * sizeof(unsigned int));
+        }
+    }
+    free(tmp);
+    free(payload_tmp);
+    return 0;
+}
+
+int radix_sort_u64(unsigned long long keys[], unsigned long long payload[], size_t n)
+{
+    unsigned long long *tmp = (unsigned long long *)malloc((n ? n : 1) * sizeof(unsigned long long));
+    unsigned long long *payload_tmp = NULL, *result;
+
+    if (tmp == NULL)
+    {
+        return -1;
+    }
+    if (payload != NULL)
+    {
+        payload_tmp = (unsigned long long *)malloc((n ? n : 1) * sizeof(unsigned long long));
+        if (payload_tmp == NULL)
+        {
+            free(tmp);
+            return -1;
+        }
+    }
+
+    result = radix_u64(keys, tmp, payload, payload_tmp, n);
+    if (result == tmp)
+    {
+        memcpy(keys, tmp, n * sizeof(unsigned long long));
+        if (payload != NULL)
+        {
+            memcpy(payload, payload_tmp, n * sizeof(unsigned long long));
+        }
+    }
+    free(tmp);
+    free(payload_tmp);
+    return (result != NULL) ? 0 : -1;
+}
+
+// Sorts arr[0 .. n) into arr[], scratch[] holding n ints
+static void sort_ints_with(int arr[], int scratch[], size_t n)
+{
+    unsigned int *result;
+
+    if (n < QUICK_LIMIT)
+    {
+        small_sort(arr, n, get_network());
+        return;
+    }
+    result = radix_u32((unsigned int *)arr, (unsigned int *)scratch, NULL, NULL, n, SIGN_FLIP);
+    if (result != (unsigned int *)arr)
+    {
+        memcpy(arr, scratch, n * sizeof(int));
+    }
+}
+
+// Sorts signed ints
+int sort_int(int arr[], size_t n)
+{
+    int *scratch;
+
+    if (n < QUICK_LIMIT)
+    {
+        small_sort(arr, n, get_network());
+        return 0;
+    }
+    scratch = (int *)malloc(n * sizeof(int));
+    if (scratch == NULL)
+    {
+        return -1;
+    }
+    sort_ints_with(arr, scratch, n);
+    free(scratch);
+    return 0;
+}
+
+// ------------------------------------------------------------------
+// Parallel sample sort
+// ------------------------------------------------------------------
+
+struct sample_sort
+{
+    int *arr, *tmp;
+    unsigned char *bucket_of;       // bucket of every value
+    size_t n, chunk;
+    int threads, buckets;
+    int splitters[MAX_THREADS * BUCKETS_PER_THREAD];   // distinct, padded with INT_MAX
+    int distinct;                   // splitters before the padding
+    int levels;                     // splitters padded to 2^levels - 1
+    // x with b splitters <= x goes to range_bucket[b], or to range_bucket[b] - 1
+    // when splitters[b - 1] is heavy and x equals it
+    int range_bucket[MAX_THREADS * BUCKETS_PER_THREAD + 1];
+    unsigned char heavy_below[MAX_THREADS * BUCKETS_PER_THREAD + 1];
+    unsigned char equal_bucket[MAX_THREADS * BUCKETS_PER_THREAD];
+    size_t counts[MAX_THREADS][MAX_THREADS * BUCKETS_PER_THREAD];
+    size_t bucket_start[MAX_THREADS * BUCKETS_PER_THREAD + 1];
+    int next_bucket;                // shared counter of phase 3
+};
+
+struct sample_task
+{
+    struct sample_sort *s;
+    int t, phase;
+};
+
+static int bucket_index(const struct sample_sort *s, int x)
+{
+    int b = 0, level;
+
+    // Implicit binary search over 2^levels - 1 sorted splitters, counting
+    // those <= x (the padding also counts for x = INT_MAX)
+    for (level = s->levels - 1; level >= 0; level--)
+    {
+        int step = 1 << level;
+
+        b += (s->splitters[b + step - 1] <= x) ? step : 0;
+    }
+    b = (b < s->distinct) ? b : s->distinct;
+    return s->range_bucket[b] - (s->heavy_below[b] & (b > 0 && s->splitters[b - 1] == x));
+}
+
+static void *sample_worker(void *arg)
+{
+    struct sample_task *task = (struct sample_task *)arg;
+    struct sample_sort *s = task->s;
+    size_t begin = task->t * s->chunk, end, i;
+
+    if (begin > s->n)
+    {
+        begin = s->n;
+    }
+    end = (begin + s->chunk < s->n) ? begin + s->chunk : s->n;
+
+    if (task->phase == 1)
+    {
+        // Tag and count
+        size_t *counts = s->counts[task->t];
+
+        memset(counts, 0, s->buckets * sizeof(size_t));
+        for (i = begin; i < end; i++)
+        {
+            int b = bucket_index(s, s->arr[i]);
+
+            s->bucket_of[i] = (unsigned char)b;
+            counts[b]++;
+        }
+    }
+    else if (task->phase == 2)
+    {
+        // Scatter : counts now hold where this chunk's part of every bucket starts
+        size_t *at = s->counts[task->t];
+
+        for (i = begin; i < end; i++)
+        {
+            s->tmp[at[s->bucket_of[i]]++] = s->arr[i];
+        }
+    }
+    else
+    {
+        // Sort whole buckets in tmp[], with arr[] as scratch, result in arr[]
+        int b;
+
+        while ((b = __atomic_fetch_add(&s->next_bucket, 1, __ATOMIC_RELAXED)) < s->buckets)
+        {
+            size_t from = s->bucket_start[b], count = s->bucket_start[b + 1] - from;
+
+            // Copies of one heavy splitter are sorted already
+            if (!s->equal_bucket[b])
+            {
+                sort_ints_with(s->tmp + from, s->arr + from, count);
+            }
+            memcpy(s->arr + from, s->tmp + from, count * sizeof(int));
+        }
+    }
+    return NULL;
+}
+
+static void run_phase(struct sample_sort *s, int phase)
+{
+    struct sample_task tasks[MAX_THREADS];
+    pthread_t tid[MAX_THREADS];
+    int started[MAX_THREADS];
+    int t;
+
+    for (t = 0; t < s->threads; t++)
+    {
+        tasks[t].s = s;
+        tasks[t].t = t;
+        tasks[t].phase = phase;
+    }
+    for (t = 1; t < s->threads; t++)
+    {
+        started[t] = (pthread_create(&tid[t], NULL, sample_worker, &tasks[t]) == 0);
+        if (!started[t])
+        {
+            sample_worker(&tasks[t]);
+        }
+    }
+    sample_worker(&tasks[0]);
+    for (t = 1; t < s->threads; t++)
+    {
+        if (started[t])
+        {
+            pthread_join(tid[t], NULL);
+        }
+    }
+}
+
+// Sorts signed ints on up to `threads` threads
+int parallel_sort_int(int arr[], size_t n, int threads)
+{
+    struct sample_sort *s;
+    int *samples;
+    size_t sample_count, i, offset = 0;
+    unsigned long long state = 0x9E3779B97F4A7C15ULL ^ n;
+    int b, t, picks, rc = 0;
+
+    if (threads > MAX_THREADS)
+    {
+        threads = MAX_THREADS;
+    }
+    if ((size_t)threads > n / MIN_CHUNK)
+    {
+        threads = (int)(n / MIN_CHUNK);
+    }
+    if (threads <= 1)
+    {
+        return sort_int(arr, n);
+    }
+
+    s = (struct sample_sort *)malloc(sizeof(struct sample_sort));
+    if (s == NULL)
+    {
+        return -1;
+    }
+    s->arr = arr;
+    s->n = n;
+    s->threads = threads;
+    s->chunk = (n + threads - 1) / threads;
+    s->next_bucket = 0;
+    s->tmp = (int *)malloc(n * sizeof(int));
+    s->bucket_of = (unsigned char *)malloc(n);
+    sample_count = (size_t)threads * BUCKETS_PER_THREAD * SAMPLES_PER_BUCKET;
+    samples = (int *)malloc(sample_count * sizeof(int));
+    if (s->tmp == NULL || s->bucket_of == NULL || samples == NULL)
+    {
+        rc = -1;
+        goto done;
+    }
+
+    // Splitters : every SAMPLES_PER_BUCKET-th of the sorted random samples
+    for (i = 0; i < sample_count; i++)
+    {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        samples[i] = arr[state % n];
+    }
+    small_sort(samples, sample_count, get_network());
+    picks = threads * BUCKETS_PER_THREAD - 1;
+    s->distinct = 0;
+    s->heavy_below[0] = 0;
+    for (b = 0; b < picks; b++)
+    {
+        int x = samples[(b + 1) * SAMPLES_PER_BUCKET];
+
+        if (s->distinct > 0 && s->splitters[s->distinct - 1] == x)
+        {
+            s->heavy_below[s->distinct] = 1;
+            continue;
+        }
+        s->splitters[s->distinct++] = x;
+        s->heavy_below[s->distinct] = 0;
+    }
+
+    // Bucket numbers in value order, an equal bucket before every range
+    // that follows a heavy splitter. At most picks + 1 buckets.
+    s->buckets = 0;
+    for (b = 0; b <= s->distinct; b++)
+    {
+        if (s->heavy_below[b])
+        {
+            s->equal_bucket[s->buckets++] = 1;
+        }
+        s->range_bucket[b] = s->buckets;
+        s->equal_bucket[s->buckets++] = 0;
+    }
+
+    for (s->levels = 0; (1 << s->levels) - 1 < s->distinct; s->levels++)
+    {
+    }
+    for (b = s->distinct; b < (1 << s->levels) - 1; b++)
+    {
+        s->splitters[b] = INT_MAX;
+    }
+
+    run_phase(s, 1);
+
+    // Place of every (bucket, chunk) pair, buckets in order
+    for (b = 0; b < s->buckets; b++)
+    {
+        s->bucket_start[b] = offset;
+        for (t = 0; t < threads; t++)
+        {
+            size_t c = s->counts[t][b];
+
+            s->counts[t][b] = offset;
+            offset += c;
+        }
+    }
+    s->bucket_start[s->buckets] = n;
+
+    run_phase(s, 2);
+    run_phase(s, 3);
+
+done:
+    free(samples);
+    free(s->tmp);
+    free(s->bucket_of);
+    free(s);
+    return rc;
+}
+
+#ifndef SORT_NO_MAIN
+
+// ------------------------------------------------------------------
+// Benchmark
+// ------------------------------------------------------------------
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static unsigned long long rng_state = 88172645463325252ULL;
+
+static unsigned long long next_random(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return rng_state;
+}
+
+static int compare_ints(const void *a, const void *b)
+{
+    int x = *(const int *)a, y = *(const int *)b;
+
+    return (x > y) - (x < y);
+}
+
+static int is_sorted(const int arr[], size_t n)
+{
+    size_t i;
+
+    for (i = 1; i < n; i++)
+    {
+        if (arr[i - 1] > arr[i])
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static void run_benchmark(int log_n)
+{
+    size_t n = (size_t)1 << log_n, i;
+    int threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    int *data = (int *)malloc(n * sizeof(int)), *work = (int *)malloc(n * sizeof(int));
+    unsigned long long *keys = (unsigned long long *)malloc(n * sizeof(unsigned long long));
+    unsigned long long *payload = (unsigned long long *)malloc(n * sizeof(unsigned long long));
+    double t0, t_qsort, t_radix, t_parallel, t_u64;
+    int ok;
+
+    if (data == NULL || work == NULL || keys == NULL || payload == NULL)
+    {
+        printf("Out of memory.\n");
+        free(data);
+        free(work);
+        free(keys);
+        free(payload);
+        return;
+    }
+    for (i = 0; i < n; i++)
+    {
+        data[i] = (int)next_random();
+        keys[i] = next_random();
+        payload[i] = i;
+    }
+
+    memcpy(work, data, n * sizeof(int));
+    t0 = now_seconds();
+    qsort(work, n, sizeof(int), compare_ints);
+    t_qsort = now_seconds() - t0;
+
+    memcpy(work, data, n * sizeof(int));
+    t0 = now_seconds();
+    ok = (sort_int(work, n) == 0);
+    t_radix = now_seconds() - t0;
+    ok = ok && is_sorted(work, n);
+
+    memcpy(work, data, n * sizeof(int));
+    t0 = now_seconds();
+    ok = ok && (parallel_sort_int(work, n, threads) == 0);
+    t_parallel = now_seconds() - t0;
+    ok = ok && is_sorted(work, n);
+
+    t0 = now_seconds();
+    ok = ok && (radix_sort_u64(keys, payload, n) == 0);
+    t_u64 = now_seconds() - t0;
+
+    printf("n = %zu, %d thread(s)%s\n", n, threads, ok ? "" : " (NOT SORTED)");
+    printf("  qsort           : %8.1f M keys / s\n", n / t_qsort * 1e-6);
+    printf("  radix           : %8.1f M keys / s\n", n / t_radix * 1e-6);
+    printf("  sample sort     : %8.1f M keys / s\n", n / t_parallel * 1e-6);
+    printf("  radix u64 + pay : %8.1f M keys / s\n", n / t_u64 * 1e-6);
+
+    free(data);
+    free(work);
+    free(keys);
+    free(payload);
+}
+
+int main(int argc, char *argv[])
+{
+    int arr[] = {29, -3, 1000000, 7, 0, -3, 42, 8, INT_MIN, 15};
+    size_t i, n = sizeof(arr) / sizeof(arr[0]);
+
+    if (argc > 1 && strcmp(argv[1], "bench") == 0)
+    {
+        run_benchmark(argc > 2 ? atoi(argv[2]) : 24);
+        return 0;
+    }
+
+    if (sort_int(arr, n) != 0)
+    {
+        printf("Out of memory.\n");
+        return 1;
+    }
+    printf("\nThe sorted array is : ");
+    for (i = 0; i < n; i++)
+    {
+        printf("%d ", arr[i]);
+    }
+    printf("\n");
+
+    return 0;
+}
+
+#endif